@@ -0,0 +1,76 @@
+/**
+ * @file BootTimeline.cpp
+ * 
+ * This file contains the function definitions for the BootTimeline
+ * class. Each part of starting up is marked by the task that does it,
+ * and only the first mark is kept, so the times can be read from the
+ * webpage to see how long it took to start balancing.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include "BootTimeline.h"
+
+/**
+ * @brief Construct a new BootTimeline object
+ */
+BootTimeline::BootTimeline(){
+    for(uint8_t n = 0; n < BOOT_PHASES; n++){
+        times[n] = 0;
+    }
+}
+
+/**
+ * @brief Marks a part of starting up as finished
+ * @details Only the first mark of each phase is kept. Every phase is
+ *          only marked by one task so no locking is needed.
+ * 
+ * @param phase Phase that finished
+ * @param now_us Time since power on in microseconds
+ */
+void BootTimeline::mark(BootPhase phase, uint32_t now_us){
+    if(times[phase] == 0){
+        // 0 means not done, so never store it
+        times[phase] = now_us == 0 ? 1 : now_us;
+    }
+}
+
+/**
+ * @brief Checks if a part of starting up has finished
+ * 
+ * @param phase Phase to check
+ * @return true if it has been marked
+ */
+bool BootTimeline::done(BootPhase phase){
+    return times[phase] != 0;
+}
+
+/**
+ * @brief Gets the time a part of starting up finished
+ * 
+ * @param phase Phase to get
+ * @return uint32_t microseconds since power on, 0 if not done
+ */
+uint32_t BootTimeline::get(BootPhase phase){
+    return times[phase];
+}
+
+/**
+ * @brief Gets a name for a phase that can be shown on the webpage
+ * 
+ * @param phase Phase to name
+ * @return const char* 
+ */
+const char* BootTimeline::phase_name(BootPhase phase){
+    switch(phase){
+        case BOOT_SETUP:        return "setup";
+        case BOOT_CONFIG:       return "config";
+        case BOOT_TASKS:        return "tasks";
+        case BOOT_IMU_READY:    return "imu_ready";
+        case BOOT_FIRST_SAMPLE: return "first_sample";
+        case BOOT_BALANCING:    return "balancing";
+        case BOOT_WIFI_READY:   return "wifi_ready";
+        case BOOT_SERVER_READY: return "server_ready";
+        default:                return "unknown";
+    }
+}
@@ -0,0 +1,43 @@
+/**
+ * @file BootTimeline.h
+ * 
+ * This file is the header file for the BootTimeline class which keeps
+ * the time each part of starting up finished at. The function
+ * definitions can be found in the BootTimeline.cpp file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef BootTimeline_h
+#define BootTimeline_h
+
+#include <stdint.h>
+
+/**
+ * @brief The parts of starting up that are timed
+ */
+enum BootPhase : uint8_t {
+    BOOT_SETUP,         ///< setup() was entered
+    BOOT_CONFIG,        ///< Saved settings were loaded
+    BOOT_TASKS,         ///< Tasks were created
+    BOOT_IMU_READY,     ///< IMU was found and reports were turned on
+    BOOT_FIRST_SAMPLE,  ///< First angle was read from the IMU
+    BOOT_BALANCING,     ///< Controller first drove the reaction wheel
+    BOOT_WIFI_READY,    ///< Soft AP is up
+    BOOT_SERVER_READY,  ///< Web server is taking requests
+    BOOT_PHASES
+};
+
+class BootTimeline{
+    private:
+        uint32_t times[BOOT_PHASES];
+    public:
+        BootTimeline();
+        void mark(BootPhase phase, uint32_t now_us);
+        bool done(BootPhase phase);
+        uint32_t get(BootPhase phase);
+        static const char* phase_name(BootPhase phase);
+};
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * @file ConfigBackend.h
+ * 
+ * This file is the header file for the storage the configuration is
+ * saved to. The store is split into a few numbered slots that each hold
+ * one saved copy of the configuration. The NVSConfigBackend saves to the
+ * ESP32 flash and the FileConfigBackend saves to a file for the tests.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef ConfigBackend_h
+#define ConfigBackend_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+class ConfigBackend{
+    public:
+        virtual ~ConfigBackend(){}
+        virtual bool read(uint8_t slot, void* data, size_t len) = 0;
+        virtual bool write(uint8_t slot, const void* data, size_t len) = 0;
+};
+
+#endif
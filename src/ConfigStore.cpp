@@ -0,0 +1,194 @@
+/**
+ * @file ConfigStore.cpp
+ * 
+ * This file contains the function definitions for the ConfigStore class.
+ * The configuration is saved with a version and a CRC so a half written
+ * or old save is never loaded. Saves go round robin through a few slots
+ * with a sequence number, so the newest good slot is loaded on start and
+ * a reset during a save only loses that one save. Saves are held back
+ * until the settings stop changing, and are written from service() so
+ * they can be ran from a low priority task instead of the balance task.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <string.h>
+#include "ConfigStore.h"
+
+#define CONFIG_MAGIC 0x42494B45
+
+/**
+ * @brief Construct a new ConfigStore object
+ * 
+ * @param store Where the slots are saved
+ * @param debounce_ms How long the settings must stay the same before saving
+ * @param max_delay_ms Longest a change can wait before it is saved
+ */
+ConfigStore::ConfigStore(ConfigBackend* store, uint32_t debounce_ms, uint32_t max_delay_ms){
+    backend = store;
+    debounce = debounce_ms;
+    max_delay = max_delay_ms;
+    sequence = 0;
+    changed_at = 0;
+    dirty_since = 0;
+    dirty = false;
+    memset(&pending, 0, sizeof(pending));
+    saves = 0;
+    failures = 0;
+}
+
+/**
+ * @brief Calculates the CRC-32 of some data
+ * @details Done bit by bit instead of with a table since it is only
+ *          used on start and when saving.
+ * 
+ * @param data Data to check
+ * @param len Number of bytes
+ * @return uint32_t 
+ */
+uint32_t ConfigStore::crc32(const void* data, size_t len){
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFF;
+    for(size_t n = 0; n < len; n++){
+        crc ^= bytes[n];
+        for(uint8_t bit = 0; bit < 8; bit++){
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Loads the newest good configuration
+ * @details Every slot is checked and the one with the highest sequence
+ *          number that has the right version and CRC is used. If no
+ *          slot is good the configuration is left as it was so the
+ *          defaults can be used. Version 1 saves have the same layout,
+ *          but only their gains, setpoint, offset and mode are used and
+ *          the rest is left as passed in, since some of them saved the
+ *          gyroscope turned off. An old save is written again as the
+ *          current version by the next service().
+ * 
+ * @param config Configuration to load into
+ * @return true if a saved configuration was loaded
+ */
+bool ConfigStore::load(BikeConfig& config){
+    ConfigBlob blob;
+    BikeConfig defaults = config;
+    bool found = false;
+    bool old = false;
+    for(uint8_t slot = 0; slot < CONFIG_SLOTS; slot++){
+        if(!backend->read(slot, &blob, sizeof(blob))){
+            continue;
+        }
+        if(blob.magic != CONFIG_MAGIC
+           || (blob.version != CONFIG_VERSION && blob.version != CONFIG_VERSION_1)
+           || blob.size != sizeof(BikeConfig)
+           || blob.crc != crc32(&blob, offsetof(ConfigBlob, crc))){
+            continue;
+        }
+        if(!found || (int32_t)(blob.sequence - sequence) > 0){
+            sequence = blob.sequence;
+            config = blob.config;
+            old = blob.version == CONFIG_VERSION_1;
+            if(old){
+                config.imu_clock = defaults.imu_clock;
+                config.rotation_interval = defaults.rotation_interval;
+                config.gyro_interval = defaults.gyro_interval;
+                config.balance_period = defaults.balance_period;
+                config.drive_period = defaults.drive_period;
+                config.steer_period = defaults.steer_period;
+            }
+            found = true;
+        }
+    }
+    pending = config;
+    if(old){
+        dirty = true;
+        changed_at = 0;
+        dirty_since = 0;
+    }
+    return found;
+}
+
+/**
+ * @brief Asks for the configuration to be saved
+ * @details This only copies the configuration. It is saved by service()
+ *          once it has stopped changing for the debounce time, or once
+ *          it has waited the max delay.
+ * 
+ * @param config Configuration to save
+ * @param now Current time in milliseconds
+ */
+void ConfigStore::request_save(const BikeConfig& config, uint32_t now){
+    if(memcmp(&config, &pending, sizeof(BikeConfig)) == 0){
+        return;
+    }
+    pending = config;
+    changed_at = now;
+    if(!dirty){
+        dirty = true;
+        dirty_since = now;
+    }
+}
+
+/**
+ * @brief Saves the configuration if it is due
+ * 
+ * @param now Current time in milliseconds
+ * @return true if a save was written
+ */
+bool ConfigStore::service(uint32_t now){
+    if(!dirty){
+        return false;
+    }
+    if((now - changed_at) < debounce && (now - dirty_since) < max_delay){
+        return false;
+    }
+    return save_now();
+}
+
+/**
+ * @brief Saves the configuration to the next slot right away
+ * @details If the write fails the configuration is kept and tried
+ *          again on the next call to service().
+ * 
+ * @return true if the save was written
+ */
+bool ConfigStore::save_now(){
+    ConfigBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.magic = CONFIG_MAGIC;
+    blob.version = CONFIG_VERSION;
+    blob.size = sizeof(BikeConfig);
+    blob.sequence = sequence + 1;
+    blob.config = pending;
+    blob.crc = crc32(&blob, offsetof(ConfigBlob, crc));
+    if(!backend->write(blob.sequence % CONFIG_SLOTS, &blob, sizeof(blob))){
+        // Left dirty so the next service() tries again
+        failures++;
+        return false;
+    }
+    dirty = false;
+    sequence = blob.sequence;
+    saves++;
+    return true;
+}
+
+/**
+ * @brief Gets the number of saves written since start
+ * 
+ * @return uint32_t 
+ */
+uint32_t ConfigStore::get_saves(){
+    return saves;
+}
+
+/**
+ * @brief Gets the number of saves that could not be written
+ * 
+ * @return uint32_t 
+ */
+uint32_t ConfigStore::get_failures(){
+    return failures;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file ConfigStore.h
+ * 
+ * This file is the header file for the ConfigStore class which lays out
+ * the configuration that is kept between resets and how it is saved.
+ * The function definitions can be found in the ConfigStore.cpp file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef ConfigStore_h
+#define ConfigStore_h
+
+#include <stdint.h>
+#include "ConfigBackend.h"
+
+//Change this whenever BikeConfig changes so old saves are not loaded.
+//Version 2 added controller_mode in place of a field that was always 0.
+//Version 1 saves are still loaded, see ConfigStore::load.
+#define CONFIG_VERSION 2
+#define CONFIG_VERSION_1 1
+#define CONFIG_SLOTS 4
+
+/**
+ * @brief Settings that are kept between resets
+ */
+struct BikeConfig{
+    float kp;                   ///< Controller KP
+    float ki;                   ///< Controller KI
+    float kd;                   ///< Controller KD
+    float setpoint;             ///< Controller setpoint after dithering
+    float imu_offset;           ///< Angle of the IMU when the bike is upright
+    // The fields below are saved for reference only, the firmware
+    // always uses its own values for them
+    uint32_t imu_clock;         ///< IMU I2C clock in Hz
+    uint32_t rotation_interval; ///< Rotation vector interval in microseconds
+    uint32_t gyro_interval;     ///< Gyroscope interval in microseconds
+    uint16_t balance_period;    ///< Balance task period in ticks
+    uint16_t drive_period;      ///< Drive task period in ticks
+    uint16_t steer_period;      ///< Steer task period in ticks
+    uint16_t controller_mode;   ///< 0 for PID, 1 for LQR
+};
+
+/**
+ * @brief What is saved in one slot
+ */
+struct ConfigBlob{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t sequence;
+    BikeConfig config;
+    uint32_t crc;
+};
+
+class ConfigStore{
+    private:
+        ConfigBackend* backend;
+        uint32_t debounce;
+        uint32_t max_delay;
+        uint32_t sequence;
+        uint32_t changed_at;
+        uint32_t dirty_since;
+        bool dirty;
+        BikeConfig pending;
+        uint32_t saves;
+        uint32_t failures;
+    public:
+        ConfigStore(ConfigBackend* store, uint32_t debounce_ms, uint32_t max_delay_ms);
+        bool load(BikeConfig& config);
+        void request_save(const BikeConfig& config, uint32_t now);
+        bool service(uint32_t now);
+        bool save_now();
+        uint32_t get_saves();
+        uint32_t get_failures();
+        static uint32_t crc32(const void* data, size_t len);
+};
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file FileConfigBackend.cpp
+ * 
+ * This file contains the function definitions for the FileConfigBackend
+ * class. Every slot is stored at a fixed place in one file so the
+ * configuration store can be checked by the native tests.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include "FileConfigBackend.h"
+
+/**
+ * @brief Construct a new FileConfigBackend object
+ * 
+ * @param file Path of the file to save to
+ * @param size Size of one slot in bytes
+ */
+FileConfigBackend::FileConfigBackend(const char* file, size_t size){
+    path = file;
+    slot_size = size;
+}
+
+/**
+ * @brief Reads one slot from the file
+ * 
+ * @param slot Slot to read
+ * @param data Where to put the slot
+ * @param len Number of bytes to read
+ * @return true if the whole slot was read
+ */
+bool FileConfigBackend::read(uint8_t slot, void* data, size_t len){
+    FILE* file = fopen(path, "rb");
+    if(file == NULL){
+        return false;
+    }
+    bool ok = fseek(file, (long)(slot * slot_size), SEEK_SET) == 0
+              && fread(data, 1, len, file) == len;
+    fclose(file);
+    return ok;
+}
+
+/**
+ * @brief Writes one slot to the file
+ * @details The file is created if it does not exist yet. The other
+ *          slots in the file are not changed.
+ * 
+ * @param slot Slot to write
+ * @param data Slot to save
+ * @param len Number of bytes to write
+ * @return true if the whole slot was written
+ */
+bool FileConfigBackend::write(uint8_t slot, const void* data, size_t len){
+    FILE* file = fopen(path, "r+b");
+    if(file == NULL){
+        file = fopen(path, "w+b");
+    }
+    if(file == NULL){
+        return false;
+    }
+    bool ok = fseek(file, (long)(slot * slot_size), SEEK_SET) == 0
+              && fwrite(data, 1, len, file) == len;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file FileConfigBackend.h
+ * 
+ * This file is the header file for the FileConfigBackend class which saves
+ * the configuration slots to a file. It is only built for the native
+ * tests in test/test_config_store and not for the ESP32. The function
+ * definitions can be found in the FileConfigBackend.cpp file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef FileConfigBackend_h
+#define FileConfigBackend_h
+
+#include "ConfigBackend.h"
+
+class FileConfigBackend : public ConfigBackend{
+    private:
+        const char* path;
+        size_t slot_size;
+    public:
+        FileConfigBackend(const char* file, size_t size);
+        bool read(uint8_t slot, void* data, size_t len);
+        bool write(uint8_t slot, const void* data, size_t len);
+};
+
+#endif
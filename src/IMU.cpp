@@ -2,8 +2,10 @@
  * @file IMU.cpp
  * 
  * This file contains the funciton defitions for the IMU class. This
- * class has two functions, one to start reading from the IMU, and one
- * to get values from the IMU. 
+ * class has two main functions, one to start reading from the IMU, and one
+ * to get values from the IMU. The IMU can be used over I2C or SPI and
+ * the rate of each report can be set before it is started. Every read
+ * is timed so the sample rate and bus time can be checked.
  * 
  * @author Mathew Smith and Cal Miller
  * @date 2023-12-08
@@ -11,21 +13,132 @@
 #include <Arduino.h>
 #include <Adafruit_BNO08x.h>
 #include <Wire.h>
+#include <SPI.h>
 #include "IMU.h"
 
 //define BNO Reset
 #define BNO08X_RESET -1
 
+//Most sensor events read in one call to getVal
+#define MAX_EVENTS 4
+
 /**
- * @brief Construct a new IMU::IMU object
+ * @brief Construct a new IMU::IMU object that uses I2C
+ * @details The BNO08x is rated for 400 kHz I2C, faster clocks such as
+ *          1 MHz can be used but should be checked with the stats.
  * 
  * @param addr Address of the I2C on the IMU
  * @param SCL The pin being used for SCL
  * @param SDA The pin being used for SDA
+ * @param clock I2C clock in Hz
  */
-IMU::IMU(uint8_t addr, uint8_t SCL, uint8_t SDA){
+IMU::IMU(uint8_t addr, uint8_t SCL, uint8_t SDA, uint32_t clock){
     i2c_addr = addr;
-    Wire.begin(SCL, SDA);
+    i2c_clock = clock;
+    spi = NULL;
+    cs_pin = 0;
+    int_pin = 0;
+    rotation_interval = 10000;
+    gyro_interval = 0;
+    rate = 0;
+    offset = 0;
+    stats = IMU_Stats();
+    window_start = 0;
+    window_samples = 0;
+    Wire.begin(SCL, SDA, clock);
+}
+
+/**
+ * @brief Construct a new IMU::IMU object that uses SPI
+ * @details SPI does not have to share the bus with anything else and runs
+ *          much faster than I2C, so it takes less time out of the balance
+ *          task for every read.
+ * 
+ * @param bus SPI bus the IMU is connected to
+ * @param cs The pin being used for chip select
+ * @param interrupt The pin being used for the IMU interrupt
+ */
+IMU::IMU(SPIClass* bus, uint8_t cs, uint8_t interrupt){
+    i2c_addr = 0;
+    i2c_clock = 0;
+    spi = bus;
+    cs_pin = cs;
+    int_pin = interrupt;
+    rotation_interval = 10000;
+    gyro_interval = 0;
+    rate = 0;
+    offset = 0;
+    stats = IMU_Stats();
+    window_start = 0;
+    window_samples = 0;
+}
+
+/**
+ * @brief Sets how often the IMU sends a report
+ * @details This must be called before start. The rotation vector is
+ *          used for the angle and the calibrated gyroscope for the
+ *          angle rate. An interval of 0 turns the report off.
+ * 
+ * @param sensor Report to change
+ * @param interval_us Time between reports in microseconds
+ */
+void IMU::set_report_interval(sh2_SensorId_t sensor, uint32_t interval_us){
+    switch(sensor){
+        case SH2_ROTATION_VECTOR:
+            rotation_interval = interval_us;
+            break;
+        case SH2_GYROSCOPE_CALIBRATED:
+            gyro_interval = interval_us;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Sets the I2C clock the IMU is read at
+ * @details Takes effect the next time the IMU is started.
+ * 
+ * @param clock I2C clock in Hz
+ */
+void IMU::set_clock(uint32_t clock){
+    i2c_clock = clock;
+}
+
+/**
+ * @brief Sets the angle the IMU reads when the bike is upright
+ * @details This is taken off every angle returned by getVal so the IMU
+ *          does not have to be mounted perfectly level.
+ * 
+ * @param angle Upright angle in radians
+ */
+void IMU::set_offset(float angle){
+    offset = angle;
+}
+
+/**
+ * @brief Gets the angle the IMU reads when the bike is upright
+ * 
+ * @return float 
+ */
+float IMU::get_offset(){
+    return offset;
+}
+
+/**
+ * @brief Turns on the reports that have an interval set
+ * 
+ * @return true if every report was turned on
+ */
+bool IMU::enable_reports(){
+    bool ok = true;
+    if(rotation_interval > 0){
+        ok = bno08x.enableReport(SH2_ROTATION_VECTOR, rotation_interval) && ok;
+    }
+    if(gyro_interval > 0){
+        ok = bno08x.enableReport(SH2_GYROSCOPE_CALIBRATED, gyro_interval) && ok;
+    }
+    return ok;
 }
 
 /**
@@ -36,22 +149,61 @@ IMU::IMU(uint8_t addr, uint8_t SCL, uint8_t SDA){
  *          accelerometer and gyro to give us values in the i, j, k and r
  *          vectors.
  * 
+ * @return true if the IMU was found, false if it could not be found
  */
-void IMU::start(){
-    if(!bno08x.begin_I2C(i2c_addr)){
+bool IMU::start(){
+    bool found;
+    if(spi != NULL){
+        found = bno08x.begin_SPI(cs_pin, int_pin, spi);
+    }else{
+        found = bno08x.begin_I2C(i2c_addr);
+        // begin_I2C restarts the bus, so make sure the clock is still set
+        Wire.setClock(i2c_clock);
+    }
+    if(!found){
         Serial.println("Could not find chip");
-        for(;;){
-            exit(1);
-        }
+        return false;
     }
     Serial.println("Found");
 
-    if(!bno08x.enableReport(SH2_ROTATION_VECTOR)){
+    if(!enable_reports()){
         Serial.println("Failed");
     }else{
         Serial.println("Succeeded");
     }
-    delay(100);
+    stats = IMU_Stats();
+    window_start = micros();
+    window_samples = 0;
+    return true;
+}
+
+/**
+ * @brief Adds one read to the stats
+ * @details The sample rate is measured over one second windows so it
+ *          shows the rate the balance task is actually getting values.
+ * 
+ * @param bus_us Time the read took in microseconds
+ * @param fresh True if the read had a new rotation vector
+ */
+void IMU::record_read(uint32_t bus_us, bool fresh){
+    uint32_t reads = stats.samples + stats.empty_reads;
+    stats.avg_read_us += (bus_us - stats.avg_read_us) / (reads + 1);
+    stats.last_read_us = bus_us;
+    if(bus_us > stats.max_read_us){
+        stats.max_read_us = bus_us;
+    }
+    if(fresh){
+        stats.samples++;
+        window_samples++;
+    }else{
+        stats.empty_reads++;
+    }
+    uint32_t now = micros();
+    if(now - window_start >= 1000000){
+        stats.sample_rate = window_samples * 1000000.0 / (now - window_start);
+        window_start = now;
+        window_samples = 0;
+    }
 }
 
 /**
@@ -59,57 +211,93 @@ void IMU::start(){
  *        i, j, k, and r. Using some math we are able to convert these
  *        values to yaw, pitch, and roll angles. Depending on the values
  *        used to calculate the roll angle, we may need to change the sign.
+ * @details Every waiting report is read, up to MAX_EVENTS, so a gyroscope
+ *          report does not hide a new rotation vector. Gyroscope values
+ *          are saved and can be read with get_rate.
  * 
  * @return float 
  */
 float IMU::getVal(){
     if(bno08x.wasReset()){
-        bno08x.enableReport(SH2_ROTATION_VECTOR);
+        enable_reports();
         Serial.println("RESET LMAOOOO");
-        delay(100);
     }
+    uint32_t start_us = micros();
+    bool fresh = false;
+    float angle = 12;
     //If there is not a value ready, return a float value that is too high
-    while(!bno08x.getSensorEvent(&sensorValue)){
-        return 12;
-    }
-    //Get the float value from the IMU
-    switch(sensorValue.sensorId){
-        case SH2_ROTATION_VECTOR:
-            float i = sensorValue.un.rotationVector.i;
-            float j = sensorValue.un.rotationVector.j;
-            float k = sensorValue.un.rotationVector.k;
-            float r = sensorValue.un.rotationVector.real;
-            float a = sensorValue.un.rotationVector.accuracy;
-/*             Serial.print("a: ");
-            Serial.print(a);
-            Serial.print(", i: ");
-            Serial.print(i);
-            Serial.print(", j: ");
-            Serial.print(j);
-            Serial.print(", k: ");
-            Serial.print(k);
-            Serial.print(", r: ");
-            Serial.print(r);
-            // Pitch will tell us what angle we are at, roll will tell us if we are in the positive or negative direction
-            Serial.print(", Yaw: ");
-            Serial.print(atan2(2.0 * (i * j + k * r), (sq(i) - sq(j) - sq(k) + sq(r)))); 
-            Serial.print(", Pitch: ");
-            Serial.print(asin(-2.0 * (i * k - j * r) / (sq(i) + sq(j) + sq(k) + sq(r))));
-            Serial.print(", Roll: ");
-            Serial.println(atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r)))); */
-            if((-sq(i) - sq(j) + sq(k) + sq(r)) > 0){
-                if(atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) > 0){
-                    return atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r)));
-                }else{
-                    return atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r)));
-                }
-            }else{
-                if(atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) > 0){
-                    return atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) - 3.14;
+    for(uint8_t n = 0; n < MAX_EVENTS && bno08x.getSensorEvent(&sensorValue); n++){
+        //Get the float value from the IMU
+        switch(sensorValue.sensorId){
+            case SH2_GYROSCOPE_CALIBRATED:
+                rate = sensorValue.un.gyroscope.x;
+                break;
+            case SH2_ROTATION_VECTOR:{
+                float i = sensorValue.un.rotationVector.i;
+                float j = sensorValue.un.rotationVector.j;
+                float k = sensorValue.un.rotationVector.k;
+                float r = sensorValue.un.rotationVector.real;
+                float a = sensorValue.un.rotationVector.accuracy;
+                /* Serial.print("a: ");
+                Serial.print(a);
+                Serial.print(", i: ");
+                Serial.print(i);
+                Serial.print(", j: ");
+                Serial.print(j);
+                Serial.print(", k: ");
+                Serial.print(k);
+                Serial.print(", r: ");
+                Serial.print(r);
+                // Pitch will tell us what angle we are at, roll will tell us if we are in the positive or negative direction
+                Serial.print(", Yaw: ");
+                Serial.print(atan2(2.0 * (i * j + k * r), (sq(i) - sq(j) - sq(k) + sq(r)))); 
+                Serial.print(", Pitch: ");
+                Serial.print(asin(-2.0 * (i * k - j * r) / (sq(i) + sq(j) + sq(k) + sq(r))));
+                Serial.print(", Roll: ");
+                Serial.println(atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r)))); */
+                if((-sq(i) - sq(j) + sq(k) + sq(r)) > 0){
+                    if(atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) > 0){
+                        angle = atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r)));
+                    }else{
+                        angle = atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r)));
+                    }
                 }else{
-                    return atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) + 3.14;
+                    if(atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) > 0){
+                        angle = atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) - 3.14;
+                    }else{
+                        angle = atan2(2.0 * (j * k + i * r), (-sq(i) - sq(j) + sq(k) + sq(r))) + 3.14;
+                    }
                 }
+                angle -= offset;
+                fresh = true;
+                break;
             }
+            default:
+                break;
+        }
     }
-    return 0;
-}
\ No newline at end of file
+    record_read(micros() - start_us, fresh);
+    return angle;
+}
+
+/**
+ * @brief Gets the latest angle rate from the gyroscope
+ * @details Only updated if the gyroscope report has an interval set.
+ * 
+ * @return float rate in radians per second
+ */
+float IMU::get_rate(){
+    return rate;
+}
+
+/**
+ * @brief Gets the read statistics of the IMU
+ * @details The stats are changed by every read, so this should only be
+ *          called from the task that reads the IMU. Other tasks should
+ *          get a copy it has shared.
+ * 
+ * @return IMU_Stats 
+ */
+IMU_Stats IMU::get_stats(){
+    return stats;
+}
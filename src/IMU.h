@@ -15,17 +15,49 @@
 #include <Arduino.h>
 #include <Adafruit_BNO08x.h>
 #include <Wire.h>
+#include <SPI.h>
 
+/**
+ * @brief Read statistics of the IMU
+ */
+struct IMU_Stats{
+    uint32_t samples;       ///< Rotation vector values read since start
+    uint32_t empty_reads;   ///< Calls to getVal with no new value
+    float sample_rate;      ///< Measured rotation vector rate in Hz
+    uint32_t last_read_us;  ///< Bus time of the last read in microseconds
+    uint32_t max_read_us;   ///< Longest bus time of a read in microseconds
+    float avg_read_us;      ///< Average bus time of a read in microseconds
+};
 
 class IMU{
     private:
         uint8_t i2c_addr;
+        uint32_t i2c_clock;
+        SPIClass* spi;
+        uint8_t cs_pin;
+        uint8_t int_pin;
+        uint32_t rotation_interval;
+        uint32_t gyro_interval;
+        float rate;
+        float offset;
         sh2_SensorValue_t sensorValue;
         Adafruit_BNO08x bno08x;
+        IMU_Stats stats;
+        uint32_t window_start;
+        uint32_t window_samples;
+        bool enable_reports();
+        void record_read(uint32_t bus_us, bool fresh);
     public:
-        IMU(uint8_t addr, uint8_t SCL, uint8_t SDA);
-        void start();
+        IMU(uint8_t addr, uint8_t SCL, uint8_t SDA, uint32_t clock = 400000);
+        IMU(SPIClass* bus, uint8_t cs, uint8_t interrupt);
+        void set_report_interval(sh2_SensorId_t sensor, uint32_t interval_us);
+        void set_clock(uint32_t clock);
+        void set_offset(float angle);
+        float get_offset();
+        bool start();
         float getVal();
+        float get_rate();
+        IMU_Stats get_stats();
 };
 
-#endif
\ No newline at end of file
+#endif
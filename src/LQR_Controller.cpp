@@ -0,0 +1,79 @@
+/**
+ * @file LQR_Controller.cpp
+ * 
+ * This file contains the function definitions for the LQR Controller.
+ * Instead of only using the tilt like the PID controller, it uses the
+ * tilt, the tilt rate and the reaction wheel speed. The gains come from
+ * LQR_Gains.h, which is made by tools/lqr_synth.cpp, so every run is just
+ * three multiplies. There is no encoder on the reaction wheel, so the
+ * wheel speed is estimated each run from the same model the gains were
+ * made from.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+
+#include <Arduino.h>
+#include "LQR_Controller.h"
+#include "LQR_Gains.h"
+#include "MotorDriver.h"
+
+/**
+ * @brief       Constructs the LQR Controller Class
+ * @details     The gains are made for one balance period, LQR_PERIOD,
+ *              so the controller must be ran at that period.
+ * @param drive         The motor that the controller updates
+ */
+LQR_Controller::LQR_Controller(MotorDriver drive){
+    motor = drive;
+    wheel_speed = 0;
+}
+
+/**
+ * @brief Clears the wheel speed estimate
+ * @details Should be called whenever the controller stops driving the
+ *          motor, since the estimate is only good while it knows what
+ *          PWM the motor has.
+ */
+void LQR_Controller::reset(){
+    wheel_speed = 0;
+}
+
+/**
+ * @brief Turns off the motor and resets the controller
+ * @details Used by the balance task to cut the reaction wheel when the
+ *          bike has fallen or the IMU has stopped reporting.
+ */
+void LQR_Controller::stop(){
+    motor.setPWM(0);
+    reset();
+}
+
+/**
+ * @brief Gets the estimated reaction wheel speed
+ * 
+ * @return float wheel speed in rad/s
+ */
+float LQR_Controller::get_wheel_speed(){
+    return wheel_speed;
+}
+
+/**
+ * @brief Runs the controller to update the motor
+ * @details The PWM is the gains times the tilt, tilt rate and wheel
+ *          speed. The PWM is then saturated the same way the motor
+ *          driver does, so the wheel speed estimate uses what the motor
+ *          was really given.
+ * 
+ * @param tilt tilt error of the bike in radians
+ * @param rate tilt rate of the bike in radians per second
+ * @param disturbance value added to the PWM sent to the motor
+ * @return float 
+ */
+float LQR_Controller::run(float tilt, float rate, float disturbance){
+    float pwmVal = LQR_K_TILT * tilt + LQR_K_RATE * rate + LQR_K_WHEEL * wheel_speed + disturbance;
+    motor.setPWM(pwmVal);
+    float applied = constrain(pwmVal, -100, 100);
+    wheel_speed = LQR_WHEEL_TILT * tilt + LQR_WHEEL_RATE * rate + LQR_WHEEL_WHEEL * wheel_speed + LQR_WHEEL_PWM * applied;
+    return pwmVal;
+}
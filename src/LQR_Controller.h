@@ -0,0 +1,30 @@
+/**
+ * @file LQR_Controller.h
+ * 
+ * This file is the header file for the LQR controller which lays out how
+ * the state feedback controller is setup. The function definitions can be
+ * found in the LQR_Controller.cpp file and the gains in LQR_Gains.h.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef LQR_Controller_h
+#define LQR_Controller_h
+
+#include <Arduino.h>
+#include "MotorDriver.h"
+
+class LQR_Controller{
+    private:
+        MotorDriver motor;
+        float wheel_speed;
+    public:
+        LQR_Controller(MotorDriver drive);
+        float run(float tilt, float rate, float disturbance = 0);
+        void reset();
+        void stop();
+        float get_wheel_speed();
+};
+
+#endif
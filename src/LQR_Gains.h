@@ -0,0 +1,34 @@
+/**
+ * @file LQR_Gains.h
+ * 
+ * This file holds the gains for the LQR_Controller and the discrete
+ * model used to estimate the wheel speed. It is made by
+ * tools/lqr_synth.cpp, so change the model there and run it again
+ * instead of changing this file.
+ * 
+ * Model: mass 0.5 kg, height 0.05 m, body inertia 0.002 kg m^2,
+ *        wheel inertia 0.0002 kg m^2, kt 0.03 Nm/A, ke 0.02 V s/rad,
+ *        resistance 1.2 ohm, supply 12 V, period 0.001 s
+ * Weights: tilt 0.2 rad, rate 2 rad/s, wheel 300 rad/s, pwm 100 %
+ * 
+ * @author Termprojet contributors
+ * 
+ */
+#ifndef LQR_Gains_h
+#define LQR_Gains_h
+
+//Balance period the gains were made for in seconds
+constexpr float LQR_PERIOD = 0.001f;
+
+//PWM = K_TILT * tilt + K_RATE * rate + K_WHEEL * wheel speed
+constexpr float LQR_K_TILT = 618.870799f;
+constexpr float LQR_K_RATE = 59.9184986f;
+constexpr float LQR_K_WHEEL = 0.523955546f;
+
+//Next wheel speed = TILT * tilt + RATE * rate + WHEEL * wheel speed + PWM * pwm
+constexpr float LQR_WHEEL_TILT = -0.122459049f;
+constexpr float LQR_WHEEL_RATE = -6.12569617e-05f;
+constexpr float LQR_WHEEL_WHEEL = 0.997253773f;
+constexpr float LQR_WHEEL_PWM = 0.0164773639f;
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file NVSConfigBackend.cpp
+ * 
+ * This file contains the function definitions for the NVSConfigBackend
+ * class. Each slot is saved as its own key in one NVS namespace. NVS
+ * already spreads writes across the flash pages so the slots do not wear
+ * out one spot.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <Arduino.h>
+#include <Preferences.h>
+#include "NVSConfigBackend.h"
+
+/**
+ * @brief Construct a new NVSConfigBackend object
+ * @details The namespace is opened on the first read or write since
+ *          NVS can not be used before the program starts.
+ * 
+ * @param space NVS namespace to save the slots in
+ */
+NVSConfigBackend::NVSConfigBackend(const char* space){
+    name = space;
+    started = false;
+}
+
+/**
+ * @brief Reads one slot from NVS
+ * 
+ * @param slot Slot to read
+ * @param data Where to put the slot
+ * @param len Number of bytes to read
+ * @return true if the whole slot was read
+ */
+bool NVSConfigBackend::read(uint8_t slot, void* data, size_t len){
+    if(!started){
+        started = prefs.begin(name, false);
+    }
+    char key[8];
+    snprintf(key, sizeof(key), "slot%u", slot);
+    return started && prefs.getBytes(key, data, len) == len;
+}
+
+/**
+ * @brief Writes one slot to NVS
+ * 
+ * @param slot Slot to write
+ * @param data Slot to save
+ * @param len Number of bytes to write
+ * @return true if the whole slot was written
+ */
+bool NVSConfigBackend::write(uint8_t slot, const void* data, size_t len){
+    if(!started){
+        started = prefs.begin(name, false);
+    }
+    char key[8];
+    snprintf(key, sizeof(key), "slot%u", slot);
+    return started && prefs.putBytes(key, data, len) == len;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file NVSConfigBackend.h
+ * 
+ * This file is the header file for the NVSConfigBackend class which saves
+ * the configuration slots to the ESP32 NVS flash. The function definitions
+ * can be found in the NVSConfigBackend.cpp file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef NVSConfigBackend_h
+#define NVSConfigBackend_h
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "ConfigBackend.h"
+
+class NVSConfigBackend : public ConfigBackend{
+    private:
+        Preferences prefs;
+        const char* name;
+        bool started;
+    public:
+        NVSConfigBackend(const char* space);
+        bool read(uint8_t slot, void* data, size_t len);
+        bool write(uint8_t slot, const void* data, size_t len);
+};
+
+#endif
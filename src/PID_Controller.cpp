@@ -36,6 +36,7 @@ PID_Controller::PID_Controller(MotorDriver drive, float portional, float integra
     setpoint = point;
     period = per;
     prev_error = 0;
+    total_error = 0;
 }
 /**
  * @brief Gets the setpoint of the controller
@@ -46,6 +47,33 @@ float PID_Controller::get_setpoint(){
     return setpoint;
 }
 
+/**
+ * @brief Gets the KP of the controller
+ * 
+ * @return float 
+ */
+float PID_Controller::get_kp(){
+    return kp;
+}
+
+/**
+ * @brief Gets the KI of the controller
+ * 
+ * @return float 
+ */
+float PID_Controller::get_ki(){
+    return ki;
+}
+
+/**
+ * @brief Gets the KD of the controller
+ * 
+ * @return float 
+ */
+float PID_Controller::get_kd(){
+    return kd;
+}
+
 /**
  * @brief Updates the setpoint of the controller
  * 
@@ -81,17 +109,50 @@ void PID_Controller::set_ki(float new_ki){
 void PID_Controller::set_kd(float new_kd){
     kd = new_kd;
 }
+/**
+ * @brief Updates the period of the controller
+ * 
+ * @param per new update period
+ */
+void PID_Controller::set_period(uint8_t per){
+    period = per;
+}
+
+/**
+ * @brief Clears the integral and derivative history of the controller
+ * @details This should be called whenever the controller stops driving
+ *          the motor so the next run does not start with a wound up
+ *          integral or a derivative kick.
+ */
+void PID_Controller::reset(){
+    total_error = 0;
+    prev_error = 0;
+}
+
+/**
+ * @brief Turns off the motor and resets the controller
+ * @details Used by the balance task to cut the reaction wheel when the
+ *          bike has fallen or the IMU has stopped reporting.
+ */
+void PID_Controller::stop(){
+    motor.setPWM(0);
+    reset();
+}
+
  /**
   * @brief Runs the controller to update the motor
   * @details The run function task the angle of the bike and compares
   *          it to the current setpoint. The error between them then 
   *          use to calculate the PWM for the motor. The error is also
   *          used to change how we change the setpoint due to dithering.
+  *          A disturbance can be added to the PWM after the controller,
+  *          which is used to test the frequency response of the loop.
   * 
   * @param val current angle of the bike
+  * @param disturbance value added to the PWM sent to the motor
   * @return float 
   */
-float PID_Controller::run(float val){
+float PID_Controller::run(float val, float disturbance){
     float error = (setpoint - val);
     total_error += error;
     float sat = 50 / ki;
@@ -107,7 +168,7 @@ float PID_Controller::run(float val){
         total_error = -sat;
     }
     float kiVal = ki * total_error;
-    float pwmVal = (kp * error) + kiVal + (kd * ((error - prev_error) / period));
+    float pwmVal = (kp * error) + kiVal + (kd * ((error - prev_error) / period)) + disturbance;
     motor.setPWM(pwmVal);
     prev_error = error;
     return pwmVal;
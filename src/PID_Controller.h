@@ -29,11 +29,17 @@ class PID_Controller{
     public:  
         PID_Controller(MotorDriver drive, float portional, float integral, float derivative, float point, uint8_t per);
         void set_setpoint(float point);
-        float run(float val);
+        float run(float val, float disturbance = 0);
         void set_kp(float new_kp);
         void set_ki(float new_ki);
         void set_kd(float new_kd);
+        void set_period(uint8_t per);
         float get_setpoint();
+        float get_kp();
+        float get_ki();
+        float get_kd();
+        void reset();
+        void stop();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+/**
+ * @file SafetyLimits.h
+ * 
+ * This file holds the angles and times the SafetySupervisor is made with.
+ * They are kept here instead of in main.cpp so the tests in
+ * test/test_supervisor check the same limits the bike uses.
+ * 
+ * @author Termprojet contributors
+ * 
+ */
+#ifndef SafetyLimits_h
+#define SafetyLimits_h
+
+//Define Safety Limits (radians and milliseconds)
+#define RECOVER_ANGLE 0.15
+#define FALL_ANGLE 0.35
+#define REARM_ANGLE 0.05
+#define ARM_TIME 250
+#define REARM_TIME 1000
+#define SENSOR_TIMEOUT 20
+#define SENSOR_START_TIMEOUT 500
+#define SENSOR_RETRY 1000
+
+#endif
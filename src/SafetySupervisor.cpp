@@ -0,0 +1,168 @@
+/**
+ * @file SafetySupervisor.cpp
+ * 
+ * This file contains the function definitions for the SafetySupervisor
+ * class. The supervisor is run once every balance period before the
+ * controller and decides if the controller is allowed to drive the
+ * reaction wheel. Every call does the same small amount of work so it
+ * never adds jitter to the control loop. It does not use any Arduino
+ * functions and is checked by the tests in test/test_supervisor.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <math.h>
+#include "SafetySupervisor.h"
+
+/**
+ * @brief Construct a new SafetySupervisor object
+ * @details All angles are in radians measured from upright, the same
+ *          as the values returned by the IMU class.
+ * 
+ * @param recover    Tilt above which the bike is recovering
+ * @param fall       Tilt above which the bike is considered fallen
+ * @param rearm      Tilt the bike must be held under to arm
+ * @param arm_ms     How long the bike must be held upright to arm at start
+ * @param rearm_ms   How long the bike must be held upright to re-arm
+ * @param timeout_ms How long without a new IMU value before a sensor fault
+ * @param start_ms   How long to wait for the first IMU value after start
+ */
+SafetySupervisor::SafetySupervisor(float recover, float fall, float rearm, uint32_t arm_ms, uint32_t rearm_ms, uint32_t timeout_ms, uint32_t start_ms){
+    state = SUP_INIT;
+    recover_angle = recover;
+    fall_angle = fall;
+    rearm_angle = rearm;
+    arm_time = arm_ms;
+    rearm_time = rearm_ms;
+    hold_time = arm_ms;
+    sensor_timeout = timeout_ms;
+    start_timeout = start_ms;
+    last_sample = 0;
+    upright_since = 0;
+    sensor_ok = false;
+    upright = false;
+    have_sample = false;
+}
+
+/**
+ * @brief Tells the supervisor if the IMU started
+ * @details If the IMU could not be started the supervisor stays in the
+ *          sensor fault state until this is called again with true.
+ *          The first value after a start is given the start timeout
+ *          instead of the sensor timeout since the IMU takes a moment
+ *          to send its first report.
+ * 
+ * @param ok  True if the IMU was found and started
+ * @param now Current time in milliseconds
+ */
+void SafetySupervisor::set_sensor_ok(bool ok, uint32_t now){
+    sensor_ok = ok;
+    last_sample = now;
+    have_sample = false;
+    if(!ok){
+        state = SUP_SENSOR_FAULT;
+    }
+}
+
+/**
+ * @brief Updates the state of the supervisor
+ * @details This should be called every balance period before running the
+ *          controller. If the bike tips past the fall angle or the IMU
+ *          stops reporting, the returned state disables the motor on the
+ *          same period it happened. The controller is only turned on
+ *          once the bike has been held upright for the arm time, so
+ *          sweeping a bike that is lying down through upright does not
+ *          start the motor. After a fall or a sensor fault the longer
+ *          re-arm time is used instead.
+ * 
+ * @param angle Latest angle of the bike
+ * @param fresh True if angle is a new value from the IMU this period
+ * @param now   Current time in milliseconds
+ * @return SupervisorState 
+ */
+SupervisorState SafetySupervisor::update(float angle, bool fresh, uint32_t now){
+    if(fresh){
+        last_sample = now;
+        have_sample = true;
+    }
+    uint32_t timeout = have_sample ? sensor_timeout : start_timeout;
+    if(!sensor_ok || (now - last_sample) > timeout){
+        state = SUP_SENSOR_FAULT;
+        upright = false;
+        hold_time = rearm_time;
+        return state;
+    }
+    if(!have_sample){
+        return state;
+    }
+
+    float tilt = fabsf(angle);
+    switch(state){
+        case SUP_BALANCING:
+        case SUP_RECOVERING:
+            if(tilt > fall_angle){
+                state = SUP_FALLEN;
+                upright = false;
+                hold_time = rearm_time;
+            }else if(tilt > recover_angle){
+                state = SUP_RECOVERING;
+            }else{
+                state = SUP_BALANCING;
+            }
+            break;
+        case SUP_SENSOR_FAULT:
+            // Sensor is back, but make the bike be held upright again
+            state = SUP_INIT;
+            upright = false;
+            // fall through
+        case SUP_INIT:
+        case SUP_FALLEN:
+            if(tilt > rearm_angle){
+                upright = false;
+            }else if(!upright){
+                upright = true;
+                upright_since = now;
+            }else if((now - upright_since) >= hold_time){
+                state = SUP_BALANCING;
+                upright = false;
+                hold_time = arm_time;
+            }
+            break;
+    }
+    return state;
+}
+
+/**
+ * @brief Checks if the controller is allowed to drive the motor
+ * 
+ * @return true if balancing or recovering
+ */
+bool SafetySupervisor::output_enabled(){
+    return state == SUP_BALANCING || state == SUP_RECOVERING;
+}
+
+/**
+ * @brief Gets the current state of the supervisor
+ * 
+ * @return SupervisorState 
+ */
+SupervisorState SafetySupervisor::get_state(){
+    return state;
+}
+
+/**
+ * @brief Gets a name for a state that can be shown on the webpage
+ * 
+ * @param s State to name
+ * @return const char* 
+ */
+const char* SafetySupervisor::state_name(SupervisorState s){
+    switch(s){
+        case SUP_INIT:          return "Init";
+        case SUP_BALANCING:     return "Balancing";
+        case SUP_RECOVERING:    return "Recovering";
+        case SUP_FALLEN:        return "Fallen";
+        case SUP_SENSOR_FAULT:  return "Sensor Fault";
+    }
+    return "Unknown";
+}
@@ -0,0 +1,54 @@
+/**
+ * @file SafetySupervisor.h
+ * 
+ * This file is the header file for the SafetySupervisor class which lays
+ * out the states the balance task can be in and when the reaction wheel is
+ * allowed to be driven. The function definitions can be found in the
+ * SafetySupervisor.cpp file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef SafetySupervisor_h
+#define SafetySupervisor_h
+
+#include <stdint.h>
+
+/**
+ * @brief The states the balance task can be in
+ */
+enum SupervisorState : uint8_t {
+    SUP_INIT,           ///< Waiting for an upright reading
+    SUP_BALANCING,      ///< Normal closed loop control
+    SUP_RECOVERING,     ///< Large tilt, still driving the wheel to save it
+    SUP_FALLEN,         ///< Past the point of recovery, motor is off
+    SUP_SENSOR_FAULT    ///< IMU missing or stopped reporting, motor is off
+};
+
+class SafetySupervisor{
+    private:
+        SupervisorState state;
+        float recover_angle;
+        float fall_angle;
+        float rearm_angle;
+        uint32_t arm_time;
+        uint32_t rearm_time;
+        uint32_t hold_time;
+        uint32_t sensor_timeout;
+        uint32_t start_timeout;
+        uint32_t last_sample;
+        uint32_t upright_since;
+        bool sensor_ok;
+        bool upright;
+        bool have_sample;
+    public:
+        SafetySupervisor(float recover, float fall, float rearm, uint32_t arm_ms, uint32_t rearm_ms, uint32_t timeout_ms, uint32_t start_ms);
+        void set_sensor_ok(bool ok, uint32_t now);
+        SupervisorState update(float angle, bool fresh, uint32_t now);
+        bool output_enabled();
+        SupervisorState get_state();
+        static const char* state_name(SupervisorState s);
+};
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file SysId.cpp
+ * 
+ * This file contains the function definitions for the SysId class. A
+ * test is asked for from the webpage, and the settings are handed to the
+ * balance task through a queue so it is the only task that changes the
+ * test. The balance task starts it on its next period. Every period the balance task gets the signal to add
+ * to the motor command from step() and then records the command and the
+ * angle with record(), so the test runs at the full balance rate. The
+ * samples are kept in a fixed buffer and read back once the test is done
+ * to find the frequency response with the tools/sysid_bode.cpp program.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <math.h>
+#include "SysId.h"
+
+/**
+ * @brief Construct a new SysId object
+ */
+SysId::SysId(){
+    running = false;
+    count = 0;
+    mode = SYSID_OFF;
+    amplitude = 0;
+    f0 = 0;
+    f1 = 0;
+    period = 0;
+    length = 0;
+    hold = 1;
+    step_count = 0;
+    phase = 0;
+    lfsr = 1;
+    level = 0;
+    current = 0;
+    last_us = 0;
+}
+
+/**
+ * @brief Starts a new test
+ * @details Must be called from the balance task, the signal starts on
+ *          the next call to step(). Starting while a test is running
+ *          does nothing. The amplitude is limited to SYSID_MAX_AMPLITUDE
+ *          so the recorded signal always fits in a SysIdSample, and the
+ *          chirp frequencies are limited to between 0 and half the
+ *          balance rate.
+ * 
+ * @param settings Settings for the test
+ */
+void SysId::start(const SysIdSettings& settings){
+    if(running){
+        return;
+    }
+    float nyquist = 0.5 / settings.period;
+    mode = settings.mode;
+    amplitude = fminf(fmaxf(fabsf(settings.amplitude), 0), SYSID_MAX_AMPLITUDE);
+    f0 = fminf(fmaxf(settings.f0, 0), nyquist);
+    f1 = fminf(fmaxf(settings.f1, 0), nyquist);
+    period = settings.period;
+    length = settings.length > SYSID_SAMPLES ? SYSID_SAMPLES : settings.length;
+    hold = settings.hold == 0 ? 1 : settings.hold;
+    step_count = 0;
+    phase = 0;
+    lfsr = 1;
+    level = amplitude;
+    last_us = 0;
+    count = 0;
+    running = mode != SYSID_OFF && length > 0;
+}
+
+/**
+ * @brief Gets the signal to add to the motor command this period
+ * @details The chirp frequency goes up linearly from f0 to f1 over the
+ *          test. The PRBS uses a 9 bit shift register so it repeats
+ *          every 511 levels.
+ * 
+ * @return float signal in PWM percent, 0 if no test is running
+ */
+float SysId::step(){
+    if(!running){
+        current = 0;
+        return current;
+    }
+    switch(mode){
+        case SYSID_CHIRP:{
+            float freq = f0 + (f1 - f0) * step_count / length;
+            current = amplitude * sinf(phase);
+            phase += 2 * M_PI * freq * period;
+            if(phase > 2 * M_PI){
+                phase -= 2 * M_PI;
+            }
+            break;
+        }
+        case SYSID_PRBS:
+            if(step_count % hold == 0){
+                uint16_t bit = ((lfsr >> 8) ^ (lfsr >> 4)) & 1;
+                lfsr = ((lfsr << 1) | bit) & 0x1FF;
+                level = bit ? amplitude : -amplitude;
+            }
+            current = level;
+            break;
+        default:
+            current = 0;
+            break;
+    }
+    step_count++;
+    return current;
+}
+
+/**
+ * @brief Records the response for this period
+ * @details Must be called once after each step() while a test is
+ *          running. The test stops by itself when the buffer is full.
+ * 
+ * @param command Total motor command in PWM percent
+ * @param angle Angle of the bike in radians
+ * @param now_us Current time in microseconds
+ */
+void SysId::record(float command, float angle, uint32_t now_us){
+    if(!running){
+        return;
+    }
+    SysIdSample& sample = samples[count];
+    uint32_t dt = last_us == 0 ? 0 : now_us - last_us;
+    sample.dt_us = dt > 0xFFFF ? 0xFFFF : dt;
+    sample.disturbance = (int16_t)lroundf(current * 100);
+    sample.command = command;
+    sample.angle = angle;
+    last_us = now_us;
+    count = count + 1;
+    if(count >= length){
+        running = false;
+    }
+}
+
+/**
+ * @brief Stops the test early
+ * @details Used when the supervisor turns off the motor. The samples
+ *          recorded so far are kept.
+ */
+void SysId::stop(){
+    running = false;
+    current = 0;
+}
+
+/**
+ * @brief Checks if a test is running
+ * 
+ * @return true if running
+ */
+bool SysId::is_running(){
+    return running;
+}
+
+/**
+ * @brief Gets the number of samples recorded in the last test
+ * 
+ * @return uint16_t 
+ */
+uint16_t SysId::get_count(){
+    return count;
+}
+
+/**
+ * @brief Gets one recorded sample
+ * 
+ * @param n Sample to get, must be less than get_count()
+ * @return const SysIdSample& 
+ */
+const SysIdSample& SysId::get_sample(uint16_t n){
+    return samples[n];
+}
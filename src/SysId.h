@@ -0,0 +1,83 @@
+/**
+ * @file SysId.h
+ * 
+ * This file is the header file for the SysId class which lays out how a
+ * test signal is added to the motor command and how the response is
+ * recorded. The function definitions can be found in the SysId.cpp file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef SysId_h
+#define SysId_h
+
+#include <stdint.h>
+
+//Number of samples that can be recorded in one test
+#define SYSID_SAMPLES 4096
+//Largest test signal in PWM percent, past this the motor saturates
+#define SYSID_MAX_AMPLITUDE 100
+
+/**
+ * @brief The test signals that can be added to the motor command
+ */
+enum SysIdMode : uint8_t {
+    SYSID_OFF,
+    SYSID_CHIRP,    ///< Sine that sweeps from f0 to f1
+    SYSID_PRBS      ///< Pseudo random +/- amplitude steps
+};
+
+/**
+ * @brief Settings for one test
+ */
+struct SysIdSettings{
+    SysIdMode mode;         ///< Test signal to use
+    float amplitude;        ///< Amplitude of the signal in PWM percent
+    float f0;               ///< Chirp start frequency in Hz
+    float f1;               ///< Chirp end frequency in Hz
+    float period;           ///< Balance period in seconds
+    uint16_t length;        ///< Number of samples to record
+    uint8_t hold;           ///< Number of periods each PRBS level is held for
+};
+
+/**
+ * @brief One recorded sample
+ */
+struct SysIdSample{
+    uint16_t dt_us;         ///< Time since the last sample in microseconds
+    int16_t disturbance;    ///< Added signal in hundredths of PWM percent
+    float command;          ///< Total motor command in PWM percent
+    float angle;            ///< Angle of the bike in radians
+};
+
+class SysId{
+    private:
+        SysIdSample samples[SYSID_SAMPLES];
+        volatile bool running;
+        volatile uint16_t count;
+        SysIdMode mode;
+        float amplitude;
+        float f0;
+        float f1;
+        float period;
+        uint16_t length;
+        uint8_t hold;
+        uint16_t step_count;
+        float phase;
+        uint16_t lfsr;
+        float level;
+        float current;
+        uint32_t last_us;
+    public:
+        SysId();
+        void start(const SysIdSettings& settings);
+        float step();
+        void record(float command, float angle, uint32_t now_us);
+        void stop();
+        bool is_running();
+        uint16_t get_count();
+        const SysIdSample& get_sample(uint16_t n);
+};
+
+#endif
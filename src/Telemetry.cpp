@@ -0,0 +1,32 @@
+/**
+ * @file Telemetry.cpp
+ * 
+ * This file contains the function that formats the state of the bike
+ * into a frame for the TelemetryBroadcaster. The frame is a server sent
+ * event holding JSON, so the webpage can read it with an EventSource.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include "Telemetry.h"
+#include "SafetySupervisor.h"
+
+/**
+ * @brief Formats the state of the bike into a frame
+ * 
+ * @param buf Where to put the frame
+ * @param len Size of buf
+ * @param snap State to format
+ * @return size_t length of the frame, 0 if it did not fit
+ */
+size_t format_telemetry(char* buf, size_t len, const TelemetrySnapshot& snap){
+    int n = snprintf(buf, len,
+                     "data: {\"t\":%lu,\"angle\":%.4f,\"pwm\":%.2f,\"setpoint\":%.4f,\"state\":\"%s\"}\n\n",
+                     (unsigned long)snap.time_ms, snap.angle, snap.pwm, snap.setpoint,
+                     SafetySupervisor::state_name((SupervisorState)snap.state));
+    if(n < 0 || (size_t)n >= len){
+        return 0;
+    }
+    return n;
+}
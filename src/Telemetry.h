@@ -0,0 +1,192 @@
+/**
+ * @file Telemetry.h
+ * 
+ * This file is the header file for the TelemetryBroadcaster class which
+ * sends the state of the bike to every connected webpage. Each publish
+ * formats the state once into one shared frame and writes that same frame
+ * to every client. A client that can not take the whole frame right away
+ * misses that frame instead of holding up the others. The class is a
+ * template on the client type so test/test_telemetry can give it fake
+ * clients. Client must have connected(), availableForWrite(), write()
+ * and stop().
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <stdint.h>
+#include <stddef.h>
+#if __has_include(<sdkconfig.h>)
+#include <sdkconfig.h>
+#else
+//Value the arduino-esp32 core is built with, for the native tests
+#define CONFIG_LWIP_MAX_SOCKETS 10
+#endif
+
+//Largest frame that can be sent
+#define TELEMETRY_FRAME 160
+
+//Sockets kept for everything else. That is the web server and telemetry
+//listeners, one web page request, and one telemetry client being turned
+//away when every slot is taken.
+#define TELEMETRY_RESERVED_SOCKETS 4
+#define TELEMETRY_CLIENTS (CONFIG_LWIP_MAX_SOCKETS - TELEMETRY_RESERVED_SOCKETS)
+
+static_assert(TELEMETRY_CLIENTS >= 1, "CONFIG_LWIP_MAX_SOCKETS is too low for telemetry");
+
+/**
+ * @brief The state of the bike sent in one frame
+ */
+struct TelemetrySnapshot{
+    uint32_t time_ms;
+    float angle;
+    float pwm;
+    float setpoint;
+    uint8_t state;
+};
+
+size_t format_telemetry(char* buf, size_t len, const TelemetrySnapshot& snap);
+
+template <class Client, uint8_t N>
+class TelemetryBroadcaster{
+    private:
+        Client clients[N];
+        bool used[N];
+        uint32_t dropped[N];
+        char frame[TELEMETRY_FRAME];
+        size_t frame_len;
+        uint32_t frames;
+        uint32_t total_dropped;
+    public:
+        TelemetryBroadcaster();
+        bool add(const Client& client, const char* header, size_t len);
+        void publish(const TelemetrySnapshot& snap);
+        uint8_t get_clients();
+        uint32_t get_frames();
+        uint32_t get_dropped();
+};
+
+/**
+ * @brief Construct a new TelemetryBroadcaster object
+ */
+template <class Client, uint8_t N>
+TelemetryBroadcaster<Client, N>::TelemetryBroadcaster(){
+    for(uint8_t n = 0; n < N; n++){
+        used[n] = false;
+        dropped[n] = 0;
+    }
+    frame_len = 0;
+    frames = 0;
+    total_dropped = 0;
+}
+
+/**
+ * @brief Adds a new client
+ * @details The header is sent to the client first. If every slot is
+ *          taken or the header can not be sent the client is closed.
+ * 
+ * @param client Client to add
+ * @param header Response header to send to the client
+ * @param len Length of the header
+ * @return true if the client was added
+ */
+template <class Client, uint8_t N>
+bool TelemetryBroadcaster<Client, N>::add(const Client& client, const char* header, size_t len){
+    for(uint8_t n = 0; n < N; n++){
+        if(used[n] && !clients[n].connected()){
+            clients[n].stop();
+            used[n] = false;
+        }
+    }
+    for(uint8_t n = 0; n < N; n++){
+        if(!used[n]){
+            clients[n] = client;
+            if(clients[n].write((const uint8_t*)header, len) != len){
+                clients[n].stop();
+                return false;
+            }
+            used[n] = true;
+            dropped[n] = 0;
+            return true;
+        }
+    }
+    Client extra = client;
+    extra.stop();
+    return false;
+}
+
+/**
+ * @brief Sends the state to every client
+ * @details The frame is only formatted once no matter how many clients
+ *          there are. Clients that have gone away are removed, and
+ *          clients without room for the whole frame skip it.
+ * 
+ * @param snap State to send
+ */
+template <class Client, uint8_t N>
+void TelemetryBroadcaster<Client, N>::publish(const TelemetrySnapshot& snap){
+    frame_len = format_telemetry(frame, sizeof(frame), snap);
+    if(frame_len == 0){
+        return;
+    }
+    frames++;
+    for(uint8_t n = 0; n < N; n++){
+        if(!used[n]){
+            continue;
+        }
+        if(!clients[n].connected()){
+            clients[n].stop();
+            used[n] = false;
+            continue;
+        }
+        if(clients[n].availableForWrite() < (int)frame_len){
+            dropped[n]++;
+            total_dropped++;
+            continue;
+        }
+        if(clients[n].write((const uint8_t*)frame, frame_len) != frame_len){
+            // Part of a frame would break the stream, so let it go
+            clients[n].stop();
+            used[n] = false;
+        }
+    }
+}
+
+/**
+ * @brief Gets the number of connected clients
+ * 
+ * @return uint8_t 
+ */
+template <class Client, uint8_t N>
+uint8_t TelemetryBroadcaster<Client, N>::get_clients(){
+    uint8_t count = 0;
+    for(uint8_t n = 0; n < N; n++){
+        count += used[n];
+    }
+    return count;
+}
+
+/**
+ * @brief Gets the number of frames published
+ * 
+ * @return uint32_t 
+ */
+template <class Client, uint8_t N>
+uint32_t TelemetryBroadcaster<Client, N>::get_frames(){
+    return frames;
+}
+
+/**
+ * @brief Gets the number of frames skipped by slow clients
+ * 
+ * @return uint32_t 
+ */
+template <class Client, uint8_t N>
+uint32_t TelemetryBroadcaster<Client, N>::get_dropped(){
+    return total_dropped;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file TelemetryClient.cpp
+ * 
+ * This file contains the function definitions for the TelemetryClient
+ * class. WiFiClient::write keeps retrying until all the data is sent,
+ * which would let one slow phone hold up every other client. Instead the
+ * socket is checked with a select() that does not wait, and written with
+ * MSG_DONTWAIT. lwIP only says a socket is writable once it has more
+ * than TCP_SNDLOWAT bytes free, which is far more than one frame, so a
+ * frame is either sent whole or skipped.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <Arduino.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include "TelemetryClient.h"
+
+/**
+ * @brief Construct an empty TelemetryClient object
+ */
+TelemetryClient::TelemetryClient(){
+}
+
+/**
+ * @brief Construct a new TelemetryClient object
+ * 
+ * @param c Client that connected to the telemetry server
+ */
+TelemetryClient::TelemetryClient(WiFiClient c){
+    client = c;
+    client.setNoDelay(true);
+}
+
+/**
+ * @brief Checks if the client is still connected
+ * 
+ * @return true if connected
+ */
+bool TelemetryClient::connected(){
+    return client.connected();
+}
+
+/**
+ * @brief Checks how much can be written without waiting
+ * 
+ * @return int TCP_SNDLOWAT if writable, 0 if not
+ */
+int TelemetryClient::availableForWrite(){
+    int fd = client.fd();
+    if(fd < 0){
+        return 0;
+    }
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(fd, &set);
+    struct timeval tv = {0, 0};
+    if(select(fd + 1, NULL, &set, NULL, &tv) <= 0){
+        return 0;
+    }
+    return TCP_SNDLOWAT;
+}
+
+/**
+ * @brief Writes data without waiting
+ * 
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return size_t number of bytes written
+ */
+size_t TelemetryClient::write(const uint8_t* data, size_t len){
+    int fd = client.fd();
+    if(fd < 0){
+        return 0;
+    }
+    int sent = send(fd, data, len, MSG_DONTWAIT);
+    return sent < 0 ? 0 : sent;
+}
+
+/**
+ * @brief Closes the client
+ */
+void TelemetryClient::stop(){
+    client.stop();
+}
@@ -0,0 +1,31 @@
+/**
+ * @file TelemetryClient.h
+ * 
+ * This file is the header file for the TelemetryClient class which lets
+ * the TelemetryBroadcaster write to a WiFiClient without ever waiting on
+ * it. The function definitions can be found in the TelemetryClient.cpp
+ * file.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ * 
+ */
+#ifndef TelemetryClient_h
+#define TelemetryClient_h
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+class TelemetryClient{
+    private:
+        WiFiClient client;
+    public:
+        TelemetryClient();
+        TelemetryClient(WiFiClient c);
+        bool connected();
+        int availableForWrite();
+        size_t write(const uint8_t* data, size_t len);
+        void stop();
+};
+
+#endif
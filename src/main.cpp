@@ -17,11 +17,26 @@
 #include "IMU.h"
 #include "MotorDriver.h"
 #include "PID_Controller.h"
+#include "LQR_Controller.h"
+#include "LQR_Gains.h"
+#include "SafetySupervisor.h"
+#include "SafetyLimits.h"
+#include "ConfigStore.h"
+#include "NVSConfigBackend.h"
+#include "BootTimeline.h"
+#include "SysId.h"
+#include "Telemetry.h"
+#include "TelemetryClient.h"
 
 Share<float> drive_val ("drive_val");
 Share<float> angle_val ("angle_val");
 Share<float> pwm_val ("pwm_val");
 Share<int> steer_val("steer_val");
+Share<uint8_t> state_val("state_val");
+Share<bool> server_ready("server_ready");
+Share<uint8_t> mode_val("mode_val");
+Share<IMU_Stats> imu_stats("imu_stats");
+Queue<SysIdSettings> sysid_queue(1, "sysid_queue", 0);
 
 //Define motor control pins
 #define IN1_1 13
@@ -36,6 +51,29 @@ Share<int> steer_val("steer_val");
 #define IMU_ADDR 0x4A
 #define IMU_SCL 21
 #define IMU_SDA 22
+#define IMU_CLOCK 400000
+
+//Define IMU Report Intervals (microseconds, 0 is off)
+#define ROTATION_INTERVAL 2500
+#define GYRO_INTERVAL 2500
+
+//Define Controller Modes
+#define MODE_PID 0
+#define MODE_LQR 1
+
+//Define Task Periods (ticks)
+#define BALANCE_PERIOD 1
+#define DRIVE_PERIOD 10
+#define STEER_PERIOD 10
+//Balance periods between printing the angle, a print every period can
+//fill the serial buffer and hold up the balance task
+#define PRINT_PERIOD 100
+
+//Define Config Saving (milliseconds and radians)
+#define CONFIG_PERIOD 200
+#define CONFIG_DEBOUNCE 2000
+#define CONFIG_MAX_DELAY 60000
+#define SETPOINT_SAVE_STEP 0.005
 
 // Initialize Servo Controller
 Servo myservo;
@@ -46,17 +84,50 @@ MotorDriver motor2 = MotorDriver(IN1_1, IN2_1);
 MotorDriver motor1 = MotorDriver(IN1_2, IN2_2);
   
 // IMU Class
-IMU bno = IMU(IMU_ADDR, IMU_SCL, IMU_SDA);
+IMU bno = IMU(IMU_ADDR, IMU_SCL, IMU_SDA, IMU_CLOCK);
+
+// Settings kept between resets, these are the defaults if none are saved
+BikeConfig config = {225, 0.1, 1000, 0, 0, IMU_CLOCK, ROTATION_INTERVAL, GYRO_INTERVAL, BALANCE_PERIOD, DRIVE_PERIOD, STEER_PERIOD, MODE_PID};
+
+// Config Storage
+NVSConfigBackend config_nvs = NVSConfigBackend("bike");
+ConfigStore config_store = ConfigStore(&config_nvs, CONFIG_DEBOUNCE, CONFIG_MAX_DELAY);
 
 // Controller Class
 PID_Controller controller = PID_Controller(motor1, 225, 0.1, 1000, 0, 1);
 
+// State Feedback Controller Class
+LQR_Controller lqr = LQR_Controller(motor1);
+
+// Supervisor Class
+SafetySupervisor supervisor = SafetySupervisor(RECOVER_ANGLE, FALL_ANGLE, REARM_ANGLE, ARM_TIME, REARM_TIME, SENSOR_TIMEOUT, SENSOR_START_TIMEOUT);
+
+// Start Up Times
+BootTimeline boot;
+
+// Frequency Response Test
+SysId sysid;
+
 //Define SSID and Password
 const char* ssid = "Controller";
 const char* password = "password1";
 
 WebServer server(80);
 
+//Define Telemetry Stream
+#define TELEMETRY_PORT 81
+#define TELEMETRY_PERIOD 100
+
+WiFiServer telemetry_server(TELEMETRY_PORT);
+TelemetryBroadcaster<TelemetryClient, TELEMETRY_CLIENTS> telemetry;
+
+//Header sent to a new telemetry client
+const char telemetry_header[] = "HTTP/1.1 200 OK\r\n"
+                                "Content-Type: text/event-stream\r\n"
+                                "Cache-Control: no-cache\r\n"
+                                "Access-Control-Allow-Origin: *\r\n"
+                                "Connection: keep-alive\r\n\r\n";
+
 //Raw HTML text
 const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 <html>
@@ -88,6 +159,9 @@ const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 <body>
   <h1>ESP32 Web Server</h1>
   <button type="submit" onClick="resetSetpoint()">Reset Setpoint</button>
+  <button type="submit" onClick="zeroIMU()">Zero IMU</button>
+  <button type="submit" onClick="setMode('pid')">PID</button>
+  <button type="submit" onClick="setMode('lqr')">LQR</button>
   <br>
   <div class="container">
     <div>
@@ -114,6 +188,10 @@ const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       <h1>Current PWM Value</h1>
       <h1 id="pwmValue">0</h1>
     </div>
+    <div class = "value">
+      <h1>Controller State</h1>
+      <h1 id="State"></h1>
+    </div>
   </div>
   <h1>KP</h1><input id="KP" type="number" step=".01"><input type="submit" value="Submit" onclick="updateKP()"><br>
   <h1>KI</h1><input id="KI" type="number" step=".01"><input type="submit" value="Submit" onclick="updateKI()"><br>
@@ -124,6 +202,7 @@ const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     var pointValue = document.getElementById('Value');
     var pwmValue = document.getElementById('pwmValue');
     var setpointValue = document.getElementById('Setpoint');
+    var stateValue = document.getElementById('State');
     var kpValue = document.getElementById('KP');
     var kiValue = document.getElementById('KI');
     var kdValue = document.getElementById('KD');
@@ -144,36 +223,6 @@ const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       xhr.open('GET', '/steer?value=' + steerVal, true);
       xhr.send();
     }
-    function getValue(){
-      var xhr = new XMLHttpRequest();
-      xhr.onreadystatechange = function(){
-        if(this.readyState == 4 && this.status == 200){
-          pointValue.innerHTML = this.responseText;
-        }
-      };
-      xhr.open("GET", "readIMU", true);
-      xhr.send();
-    }
-    function getPWM(){
-      var xhr = new XMLHttpRequest();
-      xhr.onreadystatechange = function(){
-        if(this.readyState == 4 && this.status == 200){
-          pwmValue.innerHTML = this.responseText;
-        }
-      };
-      xhr.open("GET", "readPWM", true);
-      xhr.send();
-    }
-    function getSetpoint(){
-      var xhr = new XMLHttpRequest();
-      xhr.onreadystatechange = function(){
-        if(this.readyState == 4 && this.status == 200){
-          setpointValue.innerHTML = this.responseText;
-        }
-      };
-      xhr.open("GET", "readSetpoint", true);
-      xhr.send();
-    }
     function updateKP(){
       kpVal = kpValue.value;
       var xhr = new XMLHttpRequest();
@@ -197,12 +246,24 @@ const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       xhr.open('GET', '/resetSetpoint', true);
       xhr.send();
     }
-    setInterval(function() {
-  // Call a function repetatively with 2 Second interval
-      getValue();
-      getPWM();
-      getSetpoint();
-    }, 100); //2000mSeconds update rate
+    function zeroIMU(){
+      var xhr = new XMLHttpRequest();
+      xhr.open('GET', '/zeroIMU', true);
+      xhr.send();
+    }
+    function setMode(mode){
+      var xhr = new XMLHttpRequest();
+      xhr.open('GET', '/mode?value=' + mode, true);
+      xhr.send();
+    }
+    var source = new EventSource('http://' + location.hostname + ':81/');
+    source.onmessage = function(event){
+      var data = JSON.parse(event.data);
+      pointValue.innerHTML = data.angle.toFixed(2);
+      pwmValue.innerHTML = data.pwm.toFixed(2);
+      setpointValue.innerHTML = data.setpoint.toFixed(2);
+      stateValue.innerHTML = data.state;
+    };
   </script>
 </body>
 </html>
@@ -213,28 +274,105 @@ const char html[] PROGMEM = R"rawliteral(<!DOCTYPE html>
  * @details   This taks starts reading from the IMU. If there is a new
  *            data value then it will run the controller with the new value.
  *            If there is no new data, then it will countinue to resue the
- *            previous data. The controller will update the reaction wheel
- *            with a new pwm value, depending on the error from the 
- *            centerpoint. 
+ *            previous data. Before the controller is ran the supervisor
+ *            checks the angle and how long it has been since the last
+ *            IMU value. If the bike has fallen or the IMU has stopped
+ *            reporting the motor is turned off on that same period, and
+ *            the controller is only ran again once the bike is held
+ *            upright. If the IMU can not be found it is retried instead
+ *            of stopping the program. The task starts at the same time
+ *            as the WiFi so it does not wait for the network, and the
+ *            controller is turned on once the bike has been held upright
+ *            for ARM_TIME. While a frequency response test is running its
+ *            signal is added to the motor command and the response is
+ *            recorded every period. In LQR mode the tilt rate comes from
+ *            the IMU gyroscope. The task wakes on a fixed period from
+ *            when it last woke instead of waiting a period after its
+ *            work, since the LQR gains and wheel speed estimate are made
+ *            for exactly LQR_PERIOD.
  */
 void balance(void * p_params){
   Serial.println("Balance");
-  bno.start();
-  vTaskDelay(100);
-  float point;
-  float prev;
+  bno.set_report_interval(SH2_ROTATION_VECTOR, config.rotation_interval);
+  bno.set_report_interval(SH2_GYROSCOPE_CALIBRATED, config.gyro_interval);
+  bool found = bno.start();
+  if(found){
+    boot.mark(BOOT_IMU_READY, micros());
+  }
+  supervisor.set_sensor_ok(found, millis());
+  uint32_t last_try = millis();
+  float point = 0;
+  float prev = 0;
+  float rate = 0;
+  uint8_t active = mode_val.get();
   float val;
+  uint16_t printed = 0;
+  TickType_t wake = xTaskGetTickCount();
   for(;;){
+    uint32_t now = millis();
+    if(supervisor.get_state() == SUP_SENSOR_FAULT && (now - last_try) >= SENSOR_RETRY){
+      controller.stop();
+      lqr.stop();
+      found = bno.start();
+      if(found){
+        boot.mark(BOOT_IMU_READY, micros());
+      }
+      supervisor.set_sensor_ok(found, millis());
+      last_try = now = millis();
+      // Starting the IMU takes many periods, so start the period over
+      // instead of running the missed ones back to back
+      wake = xTaskGetTickCount();
+    }
     point = bno.getVal();
-    if(point == 12){
+    // Copied whole so the web server never sees half of a read's update
+    imu_stats.put(bno.get_stats());
+    bool fresh = (point != 12);
+    if(fresh){
+      boot.mark(BOOT_FIRST_SAMPLE, micros());
+      rate = bno.get_rate();
+    }
+    if(!fresh){
       point = prev;
     }
     prev = point;
     angle_val.put(point);
-    val = controller.run(-1 * point);
-    Serial.println(point);
+    supervisor.update(point, fresh, now);
+    uint8_t mode = mode_val.get();
+    if(mode != active){
+      controller.reset();
+      lqr.reset();
+      active = mode;
+    }
+    if(sysid_queue.any()){
+      // A test asked for while the motor is off is dropped
+      SysIdSettings test;
+      sysid_queue.get(test);
+      if(supervisor.output_enabled()){
+        sysid.start(test);
+      }
+    }
+    if(supervisor.output_enabled()){
+      if(active == MODE_LQR){
+        // Same tilt error the PID uses, setpoint - (-angle)
+        val = lqr.run(controller.get_setpoint() + point, rate, sysid.step());
+      }else{
+        val = controller.run(-1 * point, sysid.step());
+      }
+      sysid.record(val, point, micros());
+      boot.mark(BOOT_BALANCING, micros());
+    }else{
+      controller.stop();
+      lqr.stop();
+      sysid.stop();
+      val = 0;
+    }
+    state_val.put(supervisor.get_state());
+    if(++printed >= PRINT_PERIOD){
+      Serial.println(point);
+      printed = 0;
+    }
     pwm_val.put(val);
-    vTaskDelay(1);
+    vTaskDelayUntil(&wake, config.balance_period);
   }
 }
 
@@ -249,7 +387,7 @@ void drive(void * p_params){
   for(;;){
     value = drive_val.get();
     motor2.setPWM(value);
-    vTaskDelay(10);
+    vTaskDelay(config.drive_period);
   }
 }
 
@@ -265,7 +403,40 @@ void steer(void * p_params){
   for(;;){
     value = steer_val.get();
     myservo.write(value);
-    vTaskDelay(10);
+    vTaskDelay(config.steer_period);
+  }
+}
+
+/**
+ * @brief   The task that saves the settings
+ * @details Every period the task copies the current gains, setpoint and
+ *          IMU offset into the config and asks the store to save it.
+ *          The store waits until the settings stop changing before it
+ *          writes to flash. Writing to flash turns off the flash cache
+ *          on both cores until it is done, which would stall the
+ *          balance task no matter its priority, so the store is only
+ *          allowed to write while the motor is off. A change made while
+ *          balancing is saved once the bike is put down. The setpoint
+ *          moves a little every period from dithering, so it is only
+ *          updated once it has moved far enough to matter.
+ */
+void saveConfig(void * p_params){
+  BikeConfig current = config;
+  for(;;){
+    current.kp = controller.get_kp();
+    current.ki = controller.get_ki();
+    current.kd = controller.get_kd();
+    current.imu_offset = bno.get_offset();
+    current.controller_mode = mode_val.get();
+    float point = controller.get_setpoint();
+    if(fabs(point - current.setpoint) >= SETPOINT_SAVE_STEP){
+      current.setpoint = point;
+    }
+    config_store.request_save(current, millis());
+    if(!supervisor.output_enabled()){
+      config_store.service(millis());
+    }
+    vTaskDelay(CONFIG_PERIOD);
   }
 }
 
@@ -293,6 +464,141 @@ void handlePWM(){
   server.send(200, "text/plane", value);
 }
 
+/**
+ * @brief   Sends the supervisor state to the server
+ * @details The task gets the most recent state of the safety supervisor
+ *          from the reaction wheel task so the webpage can show if the
+ *          bike is balancing, fallen, or has a sensor fault.
+ */
+void handleState(){
+  String value = SafetySupervisor::state_name((SupervisorState)state_val.get());
+  server.send(200, "text/plane", value);
+}
+
+/**
+ * @brief   Sends the IMU read statistics to the server
+ * @details Reports the measured sample rate and how long each read
+ *          takes on the bus so the IMU clock and report intervals
+ *          can be checked against the balance period.
+ */
+void handleIMUStats(){
+  IMU_Stats stats = imu_stats.get();
+  String value = "rate_hz=" + String(stats.sample_rate)
+               + "\nsamples=" + String(stats.samples)
+               + "\nempty_reads=" + String(stats.empty_reads)
+               + "\nlast_read_us=" + String(stats.last_read_us)
+               + "\navg_read_us=" + String(stats.avg_read_us)
+               + "\nmax_read_us=" + String(stats.max_read_us);
+  server.send(200, "text/plane", value);
+}
+
+/**
+ * @brief   Sends the start up times to the server
+ * @details Sends the time each part of starting up finished at in
+ *          milliseconds since power on, so the time it takes to
+ *          start balancing can be tracked.
+ */
+void handleBoot(){
+  String value = "";
+  for(uint8_t n = 0; n < BOOT_PHASES; n++){
+    BootPhase phase = (BootPhase)n;
+    value += BootTimeline::phase_name(phase);
+    value += "=";
+    value += boot.done(phase) ? String(boot.get(phase) / 1000.0) : String("-");
+    value += "\n";
+  }
+  server.send(200, "text/plane", value);
+}
+
+/**
+ * @brief   Starts a frequency response test
+ * @details Takes the test settings from the request. mode is chirp or
+ *          prbs, amp is the size of the signal in PWM percent, f0 and
+ *          f1 are the chirp start and end frequency in Hz, n is the
+ *          number of samples and hold is how many periods each PRBS
+ *          level is held. The test only runs while the bike is
+ *          balancing, so it is refused while the motor is off, and it
+ *          stops if the supervisor turns off the motor.
+ *          amp is limited to the PWM range. A frequency above half the
+ *          balance rate can not be made by the balance task, so it is
+ *          refused along with any other setting out of range, and
+ *          only one test can be asked for at a time.
+ */
+void handleSysId(){
+  SysIdMode mode = server.arg("mode") == "prbs" ? SYSID_PRBS : SYSID_CHIRP;
+  float amp = server.hasArg("amp") ? server.arg("amp").toFloat() : 10;
+  float f0 = server.hasArg("f0") ? server.arg("f0").toFloat() : 0.5;
+  float f1 = server.hasArg("f1") ? server.arg("f1").toFloat() : 50;
+  long n = server.hasArg("n") ? server.arg("n").toInt() : SYSID_SAMPLES;
+  long hold = server.hasArg("hold") ? server.arg("hold").toInt() : 1;
+  float nyquist = 500.0 / config.balance_period;
+  if(!(amp > 0)){
+    server.send(400, "text/plane", "amp must be above 0");
+    return;
+  }
+  if(!(f0 >= 0 && f0 <= nyquist && f1 >= 0 && f1 <= nyquist)){
+    server.send(400, "text/plane", "f0 and f1 must be between 0 and " + String(nyquist) + " Hz");
+    return;
+  }
+  if(n < 1 || n > SYSID_SAMPLES || hold < 1 || hold > 255){
+    server.send(400, "text/plane", "n must be 1 to " + String(SYSID_SAMPLES) + " and hold 1 to 255");
+    return;
+  }
+  if(!supervisor.output_enabled()){
+    server.send(409, "text/plane", "The motor is off");
+    return;
+  }
+  if(sysid.is_running() || sysid_queue.any()){
+    server.send(409, "text/plane", "A test is already running");
+    return;
+  }
+  SysIdSettings test;
+  test.mode = mode;
+  test.amplitude = constrain(amp, 0, SYSID_MAX_AMPLITUDE);
+  test.f0 = f0;
+  test.f1 = f1;
+  test.period = config.balance_period / 1000.0;
+  test.length = n;
+  test.hold = hold;
+  // The balance task starts the test, so the settings are never read
+  // while they are half written
+  sysid_queue.put(test);
+  server.send(200, "text/plane", "Started");
+}
+
+/**
+ * @brief   Sends the recorded frequency response test
+ * @details Sends every sample as a CSV line of time in microseconds,
+ *          added signal, total motor command and angle. The lines are
+ *          sent in chunks so the whole test never has to fit in one
+ *          String. Nothing is sent while a test is still running.
+ */
+void handleSysIdData(){
+  if(sysid.is_running() || sysid_queue.any()){
+    server.send(503, "text/plane", "Running");
+    return;
+  }
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/csv", "t_us,disturbance,command,angle\n");
+  char chunk[1024];
+  size_t len = 0;
+  uint32_t t = 0;
+  for(uint16_t n = 0; n < sysid.get_count(); n++){
+    const SysIdSample& sample = sysid.get_sample(n);
+    t += sample.dt_us;
+    len += snprintf(chunk + len, sizeof(chunk) - len, "%lu,%.2f,%.3f,%.5f\n",
+                    (unsigned long)t, sample.disturbance / 100.0, sample.command, sample.angle);
+    if(len > sizeof(chunk) - 64){
+      server.sendContent(chunk, len);
+      len = 0;
+    }
+  }
+  if(len > 0){
+    server.sendContent(chunk, len);
+  }
+  server.sendContent("");
+}
+
 /**
  * @brief   Updates the controller with a new KP value
  * @details The task takes the new KP value from the server and
@@ -369,22 +675,141 @@ void resetSetpoint(){
 
 
 /**
- * @brief   Sets up certain aspects of the bike balancer
- * @details Sets up the server, serial, and multitasking function for
- *          the bike balancer.
+ * @brief   Checks if the LQR can be used with the current settings
+ * @details The LQR gains are only good at the balance period they were
+ *          made for, and the LQR needs the tilt rate from the IMU
+ *          gyroscope. Settings saved before the LQR was added have the
+ *          gyroscope report turned off.
+ * 
+ * @return  NULL if the LQR can be used, otherwise why it can not
  */
-void setup() {
-  //Begin Serial
-  Serial.begin(115200);
-  while (!Serial){delay(1);}
-  Serial.println("Starting");
+const char* checkLQR(){
+  if(config.balance_period != (uint16_t)lroundf(LQR_PERIOD * 1000)){
+    return "LQR gains were made for a different period";
+  }
+  if(config.gyro_interval == 0){
+    return "LQR needs the gyroscope report turned on";
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Changes which controller balances the bike
+ * @details value is pid or lqr. LQR is refused if checkLQR finds a
+ *          problem with the settings.
+ */
+void handleMode(){
+  if(server.arg("value") == "lqr"){
+    const char* problem = checkLQR();
+    if(problem != NULL){
+      server.send(409, "text/plane", problem);
+      return;
+    }
+    mode_val.put(MODE_LQR);
+  }else{
+    mode_val.put(MODE_PID);
+  }
+  server.send(200, "text/plane", mode_val.get() == MODE_LQR ? "LQR" : "PID");
+}
+
+/**
+ * @brief   Zeros the IMU
+ * @details Takes the current angle of the bike as upright so the IMU
+ *          does not have to be mounted perfectly level. The offset is
+ *          saved with the rest of the settings.
+ */
+void zeroIMU(){
+  bno.set_offset(bno.get_offset() + angle_val.get());
+}
+
+/**
+ * @brief   Loads the saved settings
+ * @details Loads the settings from flash and gives them to the
+ *          controller and IMU. This is done before the tasks are made
+ *          so they start with the saved settings. If nothing has been
+ *          saved the defaults are used. A saved LQR mode is only used
+ *          if checkLQR allows it, otherwise the bike starts in PID.
+ *          The IMU settings and task periods can not be changed while
+ *          running, so a save only ever holds the values of the
+ *          firmware that wrote it. They are always set back to this
+ *          firmware's values so a new default is never hidden by an
+ *          old save.
+ */
+void loadConfig(){
+  if(config_store.load(config)){
+    Serial.println("Loaded saved settings");
+  }else{
+    Serial.println("Using default settings");
+  }
+  config.imu_clock = IMU_CLOCK;
+  config.rotation_interval = ROTATION_INTERVAL;
+  config.gyro_interval = GYRO_INTERVAL;
+  config.balance_period = BALANCE_PERIOD;
+  config.drive_period = DRIVE_PERIOD;
+  config.steer_period = STEER_PERIOD;
+  controller.set_kp(config.kp);
+  controller.set_ki(config.ki);
+  controller.set_kd(config.kd);
+  controller.set_setpoint(config.setpoint);
+  controller.set_period(config.balance_period);
+  mode_val.put(config.controller_mode == MODE_LQR && checkLQR() == NULL ? MODE_LQR : MODE_PID);
+  bno.set_offset(config.imu_offset);
+  bno.set_clock(config.imu_clock);
+}
+
+/**
+ * @brief   The task that streams the state of the bike to the webpages
+ * @details Once the WiFi is up the task takes any new clients on the
+ *          telemetry port and then sends one frame every period to all
+ *          of them. The state is read from the shares the balance task
+ *          already fills, so adding clients does not add any work to
+ *          the balance task, and a slow client only misses frames.
+ */
+void streamTelemetry(void * p_params){
+  while(!server_ready.get()){
+    vTaskDelay(TELEMETRY_PERIOD);
+  }
+  telemetry_server.begin();
+  TelemetrySnapshot snap;
+  for(;;){
+    WiFiClient client = telemetry_server.available();
+    while(client){
+      // The request is not needed, every client gets the same stream
+      while(client.available()){
+        client.read();
+      }
+      telemetry.add(TelemetryClient(client), telemetry_header, sizeof(telemetry_header) - 1);
+      client = telemetry_server.available();
+    }
+    snap.time_ms = millis();
+    snap.angle = angle_val.get();
+    snap.pwm = pwm_val.get();
+    snap.setpoint = controller.get_setpoint();
+    snap.state = state_val.get();
+    telemetry.publish(snap);
+    vTaskDelay(TELEMETRY_PERIOD);
+  }
+}
+
+/**
+ * @brief   The task that starts the WiFi and web server
+ * @details Bringing up the soft AP takes a long time, so it is done in
+ *          its own task while the balance task is starting the IMU.
+ *          Once the server is started loop() begins handling clients
+ *          and this task deletes itself.
+ */
+void startNetwork(void * p_params){
   WiFi.softAP(ssid, password);
+  boot.mark(BOOT_WIFI_READY, micros());
   Serial.println("Setting Up ESP32 AP Network..");
   Serial.print("Local ESP32 IP: ");
   Serial.println(WiFi.softAPIP());
   server.on("/", handleRoot);
   server.on("/readIMU", handleIMU);
   server.on("/readPWM", handlePWM);
+  server.on("/readState", handleState);
+  server.on("/imuStats", handleIMUStats);
+  server.on("/boot", handleBoot);
   server.on("/kp", handleKP);
   server.on("/ki", handleKI);
   server.on("/kd", handleKD);
@@ -392,12 +817,39 @@ void setup() {
   server.on("/drive", handleDrive);
   server.on("/readSetpoint", handleSetpoint);
   server.on("/resetSetpoint", resetSetpoint);
+  server.on("/zeroIMU", zeroIMU);
+  server.on("/mode", handleMode);
+  server.on("/sysid", handleSysId);
+  server.on("/sysidData", handleSysIdData);
   server.begin();
+  boot.mark(BOOT_SERVER_READY, micros());
+  server_ready.put(true);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief   Sets up certain aspects of the bike balancer
+ * @details Loads the saved settings and then starts every task at once.
+ *          The IMU is started in the balance task and the WiFi and
+ *          server in the network task so neither waits on the other.
+ */
+void setup() {
+  boot.mark(BOOT_SETUP, micros());
+  //Begin Serial
+  Serial.begin(115200);
+  Serial.println("Starting");
+  server_ready.put(false);
+  loadConfig();
+  boot.mark(BOOT_CONFIG, micros());
   //Create Tasks
   xTaskCreate(balance, "Balance", 9182, NULL, 3, NULL);
   //xTaskCreate(handleServer, "Server", 9182, NULL, 0, NULL);
+  xTaskCreate(startNetwork, "Network", 8192, NULL, 1, NULL);
   xTaskCreate(drive, "Drive", 2048, NULL, 1, NULL);
   xTaskCreate(steer, "Steer", 2048, NULL, 2, NULL);
+  xTaskCreate(saveConfig, "Config", 4096, NULL, 0, NULL);
+  xTaskCreate(streamTelemetry, "Telemetry", 4096, NULL, 1, NULL);
+  boot.mark(BOOT_TASKS, micros());
 }
 
 /**
@@ -405,9 +857,12 @@ void setup() {
  * @details When a new user connects or makes a new GET request,
  *          the server must know which function to run based on the
  *          request. The handle client function will tell the server
- *          where to go.
+ *          where to go. Nothing is done until the network task has
+ *          started the server.
  */
 void loop() {
-  server.handleClient();
+  if(server_ready.get()){
+    server.handleClient();
+  }
   vTaskDelay(1);
 }
@@ -0,0 +1,49 @@
+/**
+ * @file Arduino.h
+ * 
+ * This file stands in for the Arduino core when the tests are ran on a
+ * computer, so the MotorDriver and PID_Controller can be tested as they
+ * are. Only the pin functions they use are here. Every write is kept so
+ * a test can read back what a pin was last set to with native_pin().
+ * 
+ * @author Termprojet contributors
+ * 
+ */
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <math.h>
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+/**
+ * @brief Gets the last value written to every pin
+ * @details A digital HIGH is kept as 255 so it reads the same as a full
+ *          analog write.
+ * 
+ * @return int* values of the pins
+ */
+inline int* native_pins(){
+    static int pins[64];
+    return pins;
+}
+
+inline int native_pin(uint8_t pin){
+    return native_pins()[pin];
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode){}
+
+inline void digitalWrite(uint8_t pin, uint8_t val){
+    native_pins()[pin] = val == LOW ? 0 : 255;
+}
+
+inline void analogWrite(uint8_t pin, int val){
+    native_pins()[pin] = val;
+}
+
+#endif
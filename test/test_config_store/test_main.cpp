@@ -0,0 +1,223 @@
+/**
+ * @file test_main.cpp
+ * 
+ * This file contains the tests for the ConfigStore class. The store is
+ * given a FileConfigBackend so the saved slots can be read back and
+ * broken on purpose. The tests are ran on a computer with
+ * "pio test -e native".
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "ConfigStore.h"
+#include "FileConfigBackend.h"
+
+#define TEST_FILE "test_config_store.bin"
+#define DEBOUNCE 2000
+#define MAX_DELAY 60000
+
+BikeConfig defaults = {225, 0.1, 1000, 0, 0, 400000, 2500, 2500, 1, 10, 10, 0};
+
+/**
+ * @brief Makes a configuration that is different for every number
+ * 
+ * @param n Number to base the configuration on
+ * @return BikeConfig 
+ */
+BikeConfig make_config(int n){
+    BikeConfig config = defaults;
+    config.kp = 100 + n;
+    config.setpoint = 0.001 * n;
+    return config;
+}
+
+/**
+ * @brief Reads one slot straight from the test file
+ * 
+ * @param slot Slot to read
+ * @param blob Where to put the slot
+ * @return true if the slot was read
+ */
+bool read_slot(uint8_t slot, ConfigBlob& blob){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    return file.read(slot, &blob, sizeof(blob));
+}
+
+void setUp(){
+    remove(TEST_FILE);
+}
+
+void tearDown(){
+    remove(TEST_FILE);
+}
+
+void test_empty_file_keeps_defaults(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig config = defaults;
+    TEST_ASSERT_FALSE(store.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &config, sizeof(BikeConfig));
+}
+
+void test_round_trip(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig saved = make_config(7);
+    saved.controller_mode = 1;
+    store.request_save(saved, 0);
+    TEST_ASSERT_TRUE(store.save_now());
+
+    ConfigStore reload = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig config = defaults;
+    TEST_ASSERT_TRUE(reload.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&saved, &config, sizeof(BikeConfig));
+}
+
+void test_bad_crc_falls_back(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    store.request_save(make_config(1), 0);
+    TEST_ASSERT_TRUE(store.save_now());
+    store.request_save(make_config(2), 0);
+    TEST_ASSERT_TRUE(store.save_now());
+
+    // Break the newest slot as if power was lost during the write
+    ConfigBlob blob;
+    TEST_ASSERT_TRUE(read_slot(2, blob));
+    TEST_ASSERT_EQUAL(2, blob.sequence);
+    blob.config.kp += 1;
+    TEST_ASSERT_TRUE(file.write(2, &blob, sizeof(blob)));
+
+    ConfigStore reload = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig config = defaults;
+    BikeConfig older = make_config(1);
+    TEST_ASSERT_TRUE(reload.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&older, &config, sizeof(BikeConfig));
+
+    // The next save goes in the slot after the good one and replaces
+    // the broken slot
+    reload.request_save(make_config(3), 0);
+    TEST_ASSERT_TRUE(reload.save_now());
+    TEST_ASSERT_TRUE(read_slot(2, blob));
+    TEST_ASSERT_EQUAL(2, blob.sequence);
+    TEST_ASSERT_EQUAL_FLOAT(103, blob.config.kp);
+}
+
+void test_wrong_version_is_ignored(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    store.request_save(make_config(1), 0);
+    TEST_ASSERT_TRUE(store.save_now());
+
+    ConfigBlob blob;
+    TEST_ASSERT_TRUE(read_slot(1, blob));
+    blob.version = CONFIG_VERSION + 1;
+    blob.crc = ConfigStore::crc32(&blob, offsetof(ConfigBlob, crc));
+    TEST_ASSERT_TRUE(file.write(1, &blob, sizeof(blob)));
+
+    ConfigStore reload = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig config = defaults;
+    TEST_ASSERT_FALSE(reload.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &config, sizeof(BikeConfig));
+}
+
+void test_version_1_is_upgraded(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+
+    // A version 1 save from before the gyroscope was needed for LQR
+    ConfigBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.magic = 0x42494B45;
+    blob.version = CONFIG_VERSION_1;
+    blob.size = sizeof(BikeConfig);
+    blob.sequence = 5;
+    blob.config = make_config(4);
+    blob.config.gyro_interval = 0;
+    blob.config.balance_period = 2;
+    blob.config.controller_mode = 1;
+    blob.crc = ConfigStore::crc32(&blob, offsetof(ConfigBlob, crc));
+    TEST_ASSERT_TRUE(file.write(1, &blob, sizeof(blob)));
+
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig config = defaults;
+    BikeConfig upgraded = make_config(4);
+    upgraded.controller_mode = 1;
+    TEST_ASSERT_TRUE(store.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&upgraded, &config, sizeof(BikeConfig));
+
+    // It is written back as the current version without being changed
+    TEST_ASSERT_TRUE(store.service(DEBOUNCE));
+    TEST_ASSERT_TRUE(read_slot(6 % CONFIG_SLOTS, blob));
+    TEST_ASSERT_EQUAL(CONFIG_VERSION, blob.version);
+    TEST_ASSERT_EQUAL(6, blob.sequence);
+    TEST_ASSERT_EQUAL_MEMORY(&upgraded, &blob.config, sizeof(BikeConfig));
+
+    ConfigStore reload = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    config = defaults;
+    TEST_ASSERT_TRUE(reload.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&upgraded, &config, sizeof(BikeConfig));
+    TEST_ASSERT_FALSE(reload.service(DEBOUNCE));
+}
+
+void test_slot_rotation(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    for(int n = 1; n <= 2 * CONFIG_SLOTS + 1; n++){
+        store.request_save(make_config(n), 0);
+        TEST_ASSERT_TRUE(store.save_now());
+    }
+    TEST_ASSERT_EQUAL(2 * CONFIG_SLOTS + 1, store.get_saves());
+
+    // Every slot holds one of the last CONFIG_SLOTS saves
+    for(uint8_t slot = 0; slot < CONFIG_SLOTS; slot++){
+        ConfigBlob blob;
+        TEST_ASSERT_TRUE(read_slot(slot, blob));
+        TEST_ASSERT_EQUAL(slot, blob.sequence % CONFIG_SLOTS);
+        TEST_ASSERT_TRUE(blob.sequence > CONFIG_SLOTS + 1);
+        TEST_ASSERT_EQUAL_FLOAT(100 + blob.sequence, blob.config.kp);
+    }
+
+    ConfigStore reload = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    BikeConfig config = defaults;
+    BikeConfig newest = make_config(2 * CONFIG_SLOTS + 1);
+    TEST_ASSERT_TRUE(reload.load(config));
+    TEST_ASSERT_EQUAL_MEMORY(&newest, &config, sizeof(BikeConfig));
+}
+
+void test_service_waits_for_debounce(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    store.request_save(make_config(1), 1000);
+    TEST_ASSERT_FALSE(store.service(1000 + DEBOUNCE - 1));
+    TEST_ASSERT_TRUE(store.service(1000 + DEBOUNCE));
+    TEST_ASSERT_FALSE(store.service(1000 + 2 * DEBOUNCE));
+    TEST_ASSERT_EQUAL(1, store.get_saves());
+}
+
+void test_service_max_delay(){
+    FileConfigBackend file = FileConfigBackend(TEST_FILE, sizeof(ConfigBlob));
+    ConfigStore store = ConfigStore(&file, DEBOUNCE, MAX_DELAY);
+    uint32_t now = 0;
+    for(int n = 1; now < MAX_DELAY; n++){
+        store.request_save(make_config(n), now);
+        TEST_ASSERT_FALSE(store.service(now));
+        now += DEBOUNCE / 2;
+    }
+    TEST_ASSERT_TRUE(store.service(now));
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_file_keeps_defaults);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_bad_crc_falls_back);
+    RUN_TEST(test_wrong_version_is_ignored);
+    RUN_TEST(test_version_1_is_upgraded);
+    RUN_TEST(test_slot_rotation);
+    RUN_TEST(test_service_waits_for_debounce);
+    RUN_TEST(test_service_max_delay);
+    return UNITY_END();
+}
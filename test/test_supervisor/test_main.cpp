@@ -0,0 +1,328 @@
+/**
+ * @file test_main.cpp
+ * 
+ * This file contains the tests for the SafetySupervisor class. The tests
+ * are ran on a computer with "pio test -e native" and step the supervisor
+ * one balance period (1 ms) at a time. The first tests give it made up
+ * IMU values. The last tests run it in a loop with a PID_Controller,
+ * a MotorDriver and a model of the bike in the same order as the balance
+ * task, and count the periods until the motor pins are off. The angles
+ * and times come from SafetyLimits.h, the same ones used in main.cpp.
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <math.h>
+#include <Arduino.h>
+#include <unity.h>
+#include "SafetySupervisor.h"
+#include "SafetyLimits.h"
+#include "MotorDriver.h"
+#include "PID_Controller.h"
+
+//Motor driver pins on the bike
+#define IN1 25
+#define IN2 26
+//Balance periods between IMU samples, it reports every 2.5 ms
+#define SAMPLE_TICKS 3
+
+SafetySupervisor make_supervisor(){
+    return SafetySupervisor(RECOVER_ANGLE, FALL_ANGLE, REARM_ANGLE, ARM_TIME, REARM_TIME, SENSOR_TIMEOUT, SENSOR_START_TIMEOUT);
+}
+
+/**
+ * @brief Holds the bike upright with a new IMU value every period
+ * 
+ * @param sup  Supervisor to update
+ * @param from First time to update at
+ * @param to   Last time to update at
+ */
+void hold_upright(SafetySupervisor& sup, uint32_t from, uint32_t to){
+    for(uint32_t t = from; t <= to; t++){
+        sup.update(0.0, true, t);
+    }
+}
+
+/**
+ * @brief Starts the supervisor and holds the bike upright until it arms
+ * 
+ * @param sup Supervisor to arm
+ * @return uint32_t Time the supervisor armed at
+ */
+uint32_t arm(SafetySupervisor& sup){
+    sup.set_sensor_ok(true, 0);
+    hold_upright(sup, 1, 1 + ARM_TIME);
+    TEST_ASSERT_EQUAL(SUP_BALANCING, sup.get_state());
+    return 1 + ARM_TIME;
+}
+
+void setUp(){}
+
+void tearDown(){}
+
+void test_first_arm_needs_hold(){
+    SafetySupervisor sup = make_supervisor();
+    sup.set_sensor_ok(true, 0);
+    hold_upright(sup, 1, ARM_TIME);
+    TEST_ASSERT_FALSE(sup.output_enabled());
+    sup.update(0.0, true, ARM_TIME + 1);
+    TEST_ASSERT_TRUE(sup.output_enabled());
+}
+
+void test_sweep_through_upright_does_not_arm(){
+    SafetySupervisor sup = make_supervisor();
+    sup.set_sensor_ok(true, 0);
+    uint32_t t = 1;
+    for(int i = 0; i < 10; i++){
+        hold_upright(sup, t, t + ARM_TIME - 10);
+        t += ARM_TIME - 9;
+        sup.update(0.2, true, t++);
+        TEST_ASSERT_FALSE(sup.output_enabled());
+    }
+    TEST_ASSERT_EQUAL(SUP_INIT, sup.get_state());
+}
+
+void test_fall_cuts_same_tick(){
+    SafetySupervisor sup = make_supervisor();
+    uint32_t t = arm(sup);
+    sup.update(RECOVER_ANGLE + 0.01, true, ++t);
+    TEST_ASSERT_EQUAL(SUP_RECOVERING, sup.get_state());
+    sup.update(FALL_ANGLE, true, ++t);
+    TEST_ASSERT_TRUE(sup.output_enabled());
+    sup.update(-(FALL_ANGLE + 0.001), true, ++t);
+    TEST_ASSERT_EQUAL(SUP_FALLEN, sup.get_state());
+    TEST_ASSERT_FALSE(sup.output_enabled());
+}
+
+void test_timeout_cuts_on_tick_21(){
+    SafetySupervisor sup = make_supervisor();
+    uint32_t last = arm(sup);
+    for(uint32_t t = last + 1; t <= last + SENSOR_TIMEOUT; t++){
+        sup.update(0.0, false, t);
+        TEST_ASSERT_TRUE(sup.output_enabled());
+    }
+    sup.update(0.0, false, last + SENSOR_TIMEOUT + 1);
+    TEST_ASSERT_EQUAL(SUP_SENSOR_FAULT, sup.get_state());
+}
+
+void test_start_timeout(){
+    SafetySupervisor sup = make_supervisor();
+    sup.set_sensor_ok(true, 100);
+    sup.update(0.0, false, 100 + SENSOR_START_TIMEOUT);
+    TEST_ASSERT_EQUAL(SUP_INIT, sup.get_state());
+    sup.update(0.0, false, 100 + SENSOR_START_TIMEOUT + 1);
+    TEST_ASSERT_EQUAL(SUP_SENSOR_FAULT, sup.get_state());
+}
+
+void test_missing_sensor_is_fault(){
+    SafetySupervisor sup = make_supervisor();
+    sup.set_sensor_ok(false, 0);
+    TEST_ASSERT_EQUAL(SUP_SENSOR_FAULT, sup.get_state());
+    sup.update(0.0, true, 1);
+    TEST_ASSERT_EQUAL(SUP_SENSOR_FAULT, sup.get_state());
+}
+
+void test_rearm_after_fall(){
+    SafetySupervisor sup = make_supervisor();
+    uint32_t t = arm(sup);
+    sup.update(FALL_ANGLE + 0.1, true, ++t);
+    TEST_ASSERT_EQUAL(SUP_FALLEN, sup.get_state());
+    uint32_t start = t + 1;
+    hold_upright(sup, start, start + REARM_TIME - 1);
+    TEST_ASSERT_FALSE(sup.output_enabled());
+    sup.update(0.0, true, start + REARM_TIME);
+    TEST_ASSERT_TRUE(sup.output_enabled());
+}
+
+void test_rearm_restarts_when_tipped(){
+    SafetySupervisor sup = make_supervisor();
+    uint32_t t = arm(sup);
+    sup.update(FALL_ANGLE + 0.1, true, ++t);
+    hold_upright(sup, t + 1, t + REARM_TIME - 1);
+    t += REARM_TIME;
+    sup.update(REARM_ANGLE + 0.01, true, t);
+    hold_upright(sup, t + 1, t + REARM_TIME);
+    TEST_ASSERT_FALSE(sup.output_enabled());
+    sup.update(0.0, true, t + REARM_TIME + 1);
+    TEST_ASSERT_TRUE(sup.output_enabled());
+}
+
+void test_rearm_after_sensor_fault(){
+    SafetySupervisor sup = make_supervisor();
+    uint32_t t = arm(sup);
+    t += SENSOR_TIMEOUT + 1;
+    sup.update(0.0, false, t);
+    TEST_ASSERT_EQUAL(SUP_SENSOR_FAULT, sup.get_state());
+    hold_upright(sup, t + 1, t + REARM_TIME);
+    TEST_ASSERT_FALSE(sup.output_enabled());
+    sup.update(0.0, true, t + REARM_TIME + 1);
+    TEST_ASSERT_TRUE(sup.output_enabled());
+}
+
+/**
+ * @brief Model of the bike, the same one tools/lqr_synth.cpp uses
+ */
+struct Bike{
+    double tilt;    ///< Tilt in rad
+    double rate;    ///< Tilt rate in rad/s
+    double wheel;   ///< Wheel speed in rad/s
+};
+
+/**
+ * @brief Gets the PWM in percent the motor pins are set to
+ * 
+ * @return double 
+ */
+double motor_pwm(){
+    return (native_pin(IN1) - native_pin(IN2)) / 2.55;
+}
+
+/**
+ * @brief Moves the bike forward one balance period with the motor pins
+ * 
+ * @param bike Bike to move
+ */
+void step_bike(Bike& bike){
+    const int sub = 20;
+    const double dt = 0.001 / sub;
+    const double mgl = 0.5 * 9.81 * 0.05;
+    const double cu = 0.03 * 12.0 / (100 * 1.2);
+    const double cw = 0.03 * 0.02 / 1.2;
+    double u = motor_pwm();
+    for(int s = 0; s < sub; s++){
+        double torque = cu * u - cw * bike.wheel;
+        double acc = (mgl * sin(bike.tilt) - torque) / 0.002;
+        bike.tilt += bike.rate * dt;
+        bike.rate += acc * dt;
+        bike.wheel += (torque / 2e-4 - acc) * dt;
+    }
+}
+
+/**
+ * @brief The balance task and the bike it runs
+ */
+struct Rig{
+    SafetySupervisor sup;
+    MotorDriver motor;
+    PID_Controller controller;
+    Bike bike;
+    uint32_t now;
+    bool reporting;     ///< False once the IMU stops reporting
+    float point;
+
+    Rig() : sup(make_supervisor()), motor(IN1, IN2), controller(motor, 225, 0.1, 1000, 0, 1){
+        bike = {0, 0, 0};
+        now = 0;
+        reporting = true;
+        point = 0;
+        sup.set_sensor_ok(true, now);
+    }
+
+    /**
+     * @brief Runs one balance period in the order the balance task does
+     * @details The IMU is read, the supervisor is updated, the controller
+     *          drives or stops the motor, and then the bike moves with
+     *          what the motor pins were left at.
+     * 
+     * @return true if a new IMU sample was used
+     */
+    bool tick(){
+        now++;
+        bool fresh = reporting && now % SAMPLE_TICKS == 0;
+        if(fresh){
+            point = bike.tilt;
+        }
+        sup.update(point, fresh, now);
+        if(sup.output_enabled()){
+            controller.run(-1 * point);
+        }else{
+            controller.stop();
+        }
+        step_bike(bike);
+        return fresh;
+    }
+
+    /**
+     * @brief Holds the bike upright until the supervisor arms
+     */
+    void arm(){
+        while(!sup.output_enabled()){
+            TEST_ASSERT_TRUE(now < 2 * ARM_TIME);
+            tick();
+        }
+    }
+};
+
+void test_plant_fall_cuts_motor(){
+    Rig rig;
+    rig.arm();
+    for(int n = 0; n < 500; n++){
+        rig.tick();
+    }
+    TEST_ASSERT_TRUE(fabs(rig.bike.tilt) < RECOVER_ANGLE);
+    TEST_ASSERT_TRUE(rig.sup.output_enabled());
+
+    // Shove the bike harder than the wheel can catch
+    rig.bike.rate = 8;
+    int crossed = -1;
+    int sampled = -1;
+    int cut = -1;
+    for(int n = 0; n < 200 && cut < 0; n++){
+        double before = rig.bike.tilt;
+        bool fresh = rig.tick();
+        if(crossed < 0 && fabs(before) > FALL_ANGLE){
+            crossed = n;
+        }
+        if(sampled < 0 && fresh && fabs(rig.point) > FALL_ANGLE){
+            sampled = n;
+        }
+        if(native_pin(IN1) == 0 && native_pin(IN2) == 0){
+            cut = n;
+        }
+    }
+    TEST_ASSERT_TRUE(crossed >= 0);
+    TEST_ASSERT_EQUAL(SUP_FALLEN, rig.sup.get_state());
+    // Cut on the same period the first sample past the limit is read,
+    // which is at most one IMU report after the bike really crossed it
+    TEST_ASSERT_EQUAL(sampled, cut);
+    TEST_ASSERT_LESS_OR_EQUAL(SAMPLE_TICKS - 1, cut - crossed);
+    TEST_ASSERT_EQUAL(0, motor_pwm());
+}
+
+void test_plant_sensor_loss_cuts_motor(){
+    Rig rig;
+    rig.arm();
+    for(int n = 0; n < 500; n++){
+        rig.tick();
+    }
+    TEST_ASSERT_TRUE(rig.sup.output_enabled());
+
+    // Stop right after a sample, then count the periods without one
+    while(!rig.tick());
+    rig.reporting = false;
+    int cut = -1;
+    for(int n = 1; n <= 2 * SENSOR_TIMEOUT && cut < 0; n++){
+        rig.tick();
+        if(native_pin(IN1) == 0 && native_pin(IN2) == 0){
+            cut = n;
+        }
+    }
+    TEST_ASSERT_EQUAL(SENSOR_TIMEOUT + 1, cut);
+    TEST_ASSERT_EQUAL(SUP_SENSOR_FAULT, rig.sup.get_state());
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_first_arm_needs_hold);
+    RUN_TEST(test_sweep_through_upright_does_not_arm);
+    RUN_TEST(test_fall_cuts_same_tick);
+    RUN_TEST(test_timeout_cuts_on_tick_21);
+    RUN_TEST(test_start_timeout);
+    RUN_TEST(test_missing_sensor_is_fault);
+    RUN_TEST(test_rearm_after_fall);
+    RUN_TEST(test_rearm_restarts_when_tipped);
+    RUN_TEST(test_rearm_after_sensor_fault);
+    RUN_TEST(test_plant_fall_cuts_motor);
+    RUN_TEST(test_plant_sensor_loss_cuts_motor);
+    return UNITY_END();
+}
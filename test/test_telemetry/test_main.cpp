@@ -0,0 +1,247 @@
+/**
+ * @file test_main.cpp
+ * 
+ * This file contains the tests for the TelemetryBroadcaster class. The
+ * broadcaster is given fake clients that keep what was written to them
+ * and can be made slow or disconnected by the test. The tests are ran on
+ * a computer with "pio test -e native".
+ * 
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <string.h>
+#include <unity.h>
+#include "Telemetry.h"
+#include "SafetySupervisor.h"
+
+#define HEADER "HTTP/1.1 200 OK\r\n\r\n"
+
+/**
+ * @brief The far end of a fake client, kept by the test
+ */
+struct FakeLink{
+    bool connected;     ///< False once the webpage has gone away
+    int room;           ///< Bytes that can be written without blocking
+    size_t short_by;    ///< Bytes each write comes up short by
+    bool stopped;       ///< Set when the broadcaster closes the client
+    int writes;         ///< Number of writes
+    int checks;         ///< Calls to connected() and availableForWrite()
+    const uint8_t* data; ///< Buffer given to the last write
+    char last[TELEMETRY_FRAME];
+    size_t last_len;
+};
+
+/**
+ * @brief Fake client with the same functions as TelemetryClient
+ */
+class FakeClient{
+    private:
+        FakeLink* link;
+    public:
+        FakeClient(){
+            link = NULL;
+        }
+        FakeClient(FakeLink* l){
+            link = l;
+        }
+        bool connected(){
+            if(link == NULL){
+                return false;
+            }
+            link->checks++;
+            return link->connected && !link->stopped;
+        }
+        int availableForWrite(){
+            link->checks++;
+            return link->room;
+        }
+        size_t write(const uint8_t* data, size_t len){
+            link->writes++;
+            link->data = data;
+            size_t sent = len > link->short_by ? len - link->short_by : 0;
+            link->last_len = sent < sizeof(link->last) ? sent : sizeof(link->last);
+            memcpy(link->last, data, link->last_len);
+            return sent;
+        }
+        void stop(){
+            if(link != NULL){
+                link->stopped = true;
+            }
+        }
+};
+
+FakeLink new_link(){
+    FakeLink link;
+    memset(&link, 0, sizeof(link));
+    link.connected = true;
+    link.room = 1024;
+    return link;
+}
+
+TelemetrySnapshot snap = {1234, 0.0123, -45.5, 0.002, SUP_BALANCING};
+
+void setUp(){}
+
+void tearDown(){}
+
+void test_format(){
+    char buf[TELEMETRY_FRAME];
+    size_t len = format_telemetry(buf, sizeof(buf), snap);
+    TEST_ASSERT_EQUAL_STRING("data: {\"t\":1234,\"angle\":0.0123,\"pwm\":-45.50,"
+                             "\"setpoint\":0.0020,\"state\":\"Balancing\"}\n\n", buf);
+    TEST_ASSERT_EQUAL(strlen(buf), len);
+    TEST_ASSERT_EQUAL(0, format_telemetry(buf, 20, snap));
+}
+
+void test_every_client_gets_the_frame(){
+    TelemetryBroadcaster<FakeClient, 4> telemetry;
+    FakeLink links[3] = {new_link(), new_link(), new_link()};
+    for(int i = 0; i < 3; i++){
+        TEST_ASSERT_TRUE(telemetry.add(FakeClient(&links[i]), HEADER, strlen(HEADER)));
+    }
+    telemetry.publish(snap);
+    char frame[TELEMETRY_FRAME];
+    size_t len = format_telemetry(frame, sizeof(frame), snap);
+    for(int i = 0; i < 3; i++){
+        TEST_ASSERT_EQUAL(2, links[i].writes);
+        TEST_ASSERT_EQUAL(len, links[i].last_len);
+        TEST_ASSERT_EQUAL_MEMORY(frame, links[i].last, len);
+    }
+    TEST_ASSERT_EQUAL(1, telemetry.get_frames());
+    TEST_ASSERT_EQUAL(0, telemetry.get_dropped());
+}
+
+void test_slow_client_drops_frames(){
+    TelemetryBroadcaster<FakeClient, 4> telemetry;
+    FakeLink fast = new_link();
+    FakeLink slow = new_link();
+    telemetry.add(FakeClient(&fast), HEADER, strlen(HEADER));
+    telemetry.add(FakeClient(&slow), HEADER, strlen(HEADER));
+    slow.room = 10;
+    for(int i = 0; i < 5; i++){
+        telemetry.publish(snap);
+    }
+    TEST_ASSERT_EQUAL(6, fast.writes);
+    TEST_ASSERT_EQUAL(1, slow.writes);
+    TEST_ASSERT_EQUAL(5, telemetry.get_dropped());
+    TEST_ASSERT_EQUAL(5, telemetry.get_frames());
+    // A slow client is kept and gets frames again once it has room
+    TEST_ASSERT_EQUAL(2, telemetry.get_clients());
+    slow.room = 1024;
+    telemetry.publish(snap);
+    TEST_ASSERT_EQUAL(2, slow.writes);
+    TEST_ASSERT_EQUAL(5, telemetry.get_dropped());
+}
+
+void test_disconnected_client_is_removed(){
+    TelemetryBroadcaster<FakeClient, 4> telemetry;
+    FakeLink stays = new_link();
+    FakeLink leaves = new_link();
+    telemetry.add(FakeClient(&stays), HEADER, strlen(HEADER));
+    telemetry.add(FakeClient(&leaves), HEADER, strlen(HEADER));
+    leaves.connected = false;
+    telemetry.publish(snap);
+    TEST_ASSERT_TRUE(leaves.stopped);
+    TEST_ASSERT_EQUAL(1, leaves.writes);
+    TEST_ASSERT_EQUAL(1, telemetry.get_clients());
+    TEST_ASSERT_EQUAL(2, stays.writes);
+}
+
+void test_partial_write_removes_client(){
+    TelemetryBroadcaster<FakeClient, 4> telemetry;
+    FakeLink link = new_link();
+    telemetry.add(FakeClient(&link), HEADER, strlen(HEADER));
+    link.short_by = 1;
+    telemetry.publish(snap);
+    TEST_ASSERT_TRUE(link.stopped);
+    TEST_ASSERT_EQUAL(0, telemetry.get_clients());
+}
+
+void test_full_rejects_new_client(){
+    TelemetryBroadcaster<FakeClient, 2> telemetry;
+    FakeLink links[3] = {new_link(), new_link(), new_link()};
+    TEST_ASSERT_TRUE(telemetry.add(FakeClient(&links[0]), HEADER, strlen(HEADER)));
+    TEST_ASSERT_TRUE(telemetry.add(FakeClient(&links[1]), HEADER, strlen(HEADER)));
+    TEST_ASSERT_FALSE(telemetry.add(FakeClient(&links[2]), HEADER, strlen(HEADER)));
+    TEST_ASSERT_TRUE(links[2].stopped);
+    TEST_ASSERT_EQUAL(0, links[2].writes);
+    TEST_ASSERT_EQUAL(2, telemetry.get_clients());
+
+    // A slot freed by a client that left is used again
+    links[0].connected = false;
+    FakeLink next = new_link();
+    TEST_ASSERT_TRUE(telemetry.add(FakeClient(&next), HEADER, strlen(HEADER)));
+    TEST_ASSERT_TRUE(links[0].stopped);
+    TEST_ASSERT_EQUAL(2, telemetry.get_clients());
+}
+
+void test_failed_header_rejects_client(){
+    TelemetryBroadcaster<FakeClient, 2> telemetry;
+    FakeLink link = new_link();
+    link.short_by = 1;
+    TEST_ASSERT_FALSE(telemetry.add(FakeClient(&link), HEADER, strlen(HEADER)));
+    TEST_ASSERT_TRUE(link.stopped);
+    TEST_ASSERT_EQUAL(0, telemetry.get_clients());
+}
+
+void test_publish_cost_with_client_count(){
+    char frame[TELEMETRY_FRAME];
+    size_t len = format_telemetry(frame, sizeof(frame), snap);
+    for(int count = 0; count <= TELEMETRY_CLIENTS; count++){
+        TelemetryBroadcaster<FakeClient, TELEMETRY_CLIENTS> telemetry;
+        FakeLink links[TELEMETRY_CLIENTS];
+        int slow = 0;
+        for(int i = 0; i < count; i++){
+            links[i] = new_link();
+            TEST_ASSERT_TRUE(telemetry.add(FakeClient(&links[i]), HEADER, strlen(HEADER)));
+            // Every third client has no room, like a webpage on a bad link
+            if(i % 3 == 1){
+                links[i].room = len - 1;
+                slow++;
+            }
+        }
+        for(int p = 1; p <= 3; p++){
+            for(int i = 0; i < count; i++){
+                links[i].checks = 0;
+                links[i].writes = 0;
+                links[i].data = NULL;
+            }
+            telemetry.publish(snap);
+            // One frame is formatted no matter how many clients there are
+            TEST_ASSERT_EQUAL(p, telemetry.get_frames());
+            const uint8_t* shared = NULL;
+            for(int i = 0; i < count; i++){
+                // Each client costs the same fixed number of calls
+                TEST_ASSERT_EQUAL(2, links[i].checks);
+                if(i % 3 == 1){
+                    // A slow client is never written to, so it can not block
+                    TEST_ASSERT_EQUAL(0, links[i].writes);
+                    continue;
+                }
+                TEST_ASSERT_EQUAL(1, links[i].writes);
+                TEST_ASSERT_EQUAL(len, links[i].last_len);
+                TEST_ASSERT_EQUAL_MEMORY(frame, links[i].last, len);
+                // Every client is sent the same buffer
+                if(shared == NULL){
+                    shared = links[i].data;
+                }
+                TEST_ASSERT_TRUE(shared == links[i].data);
+            }
+        }
+        TEST_ASSERT_EQUAL(count, telemetry.get_clients());
+        TEST_ASSERT_EQUAL(3 * slow, telemetry.get_dropped());
+    }
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_format);
+    RUN_TEST(test_every_client_gets_the_frame);
+    RUN_TEST(test_slow_client_drops_frames);
+    RUN_TEST(test_disconnected_client_is_removed);
+    RUN_TEST(test_partial_write_removes_client);
+    RUN_TEST(test_full_rejects_new_client);
+    RUN_TEST(test_failed_header_rejects_client);
+    RUN_TEST(test_publish_cost_with_client_count);
+    return UNITY_END();
+}
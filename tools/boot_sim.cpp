@@ -0,0 +1,226 @@
+/**
+ * @file boot_sim.cpp
+ *
+ * This file is a program that is ran on a computer to compare how long
+ * the bike takes to start with the old serial boot and with the boot
+ * where the IMU and the WiFi are started at the same time. Each boot is
+ * written as a list of steps that each take a fixed time and wait for
+ * the step before them, and the time each phase from BootTimeline is
+ * reached is printed for both. The IMU and the WiFi steps are taken to
+ * run fully in parallel, since the I2C start waits on the IMU and the
+ * soft AP waits on the WiFi driver.
+ *
+ * Build and run with:
+ *     g++ -O2 -std=c++11 -o boot_sim tools/boot_sim.cpp
+ *     ./boot_sim -wifi 300 -imu 60
+ *
+ * The default times are estimates, run with -h to see them. Replace them
+ * with the times served by /boot on the bike to check the model.
+ *
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Marks a step that does not wait on any other step
+#define START -1
+
+/**
+ * @brief How long each part of starting up takes in ms
+ */
+struct BootTimes{
+    double serial;      ///< Waiting for Serial in setup()
+    double config;      ///< Loading the saved settings
+    double tasks;       ///< Creating the tasks
+    double imu;         ///< Finding the IMU and turning on its reports
+    double report;      ///< Time until the first report after turning it on
+    double wifi;        ///< Bringing up the soft AP
+    double server;      ///< Adding the routes and starting the web server
+    double arm;         ///< Upright hold before the first arm
+    double imu_wait;    ///< Old fixed wait at the end of IMU::start
+    double task_wait;   ///< Old fixed wait in the balance task
+};
+
+/**
+ * @brief The phases from BootTimeline
+ */
+enum Phase{
+    CONFIG,
+    TASKS,
+    IMU_READY,
+    FIRST_SAMPLE,
+    BALANCING,
+    WIFI_READY,
+    SERVER_READY,
+    PHASES
+};
+
+const char* phase_names[PHASES] = {
+    "config", "tasks", "imu_ready", "first_sample", "balancing",
+    "wifi_ready", "server_ready"
+};
+
+/**
+ * @brief One step of starting up
+ */
+struct Step{
+    int phase;          ///< Phase reached when the step is done, -1 for none
+    double duration;    ///< Time the step takes in ms
+    int after;          ///< Step it waits for, START for none
+};
+
+/**
+ * @brief Finds when each phase is reached
+ * @details The steps must be in an order where every step comes after
+ *          the one it waits for.
+ *
+ * @param steps Steps of the boot
+ * @param count Number of steps
+ * @param phases Time each phase is reached in ms, -1 if never
+ */
+void run(const Step* steps, int count, double* phases){
+    double done[16];
+    for(int p = 0; p < PHASES; p++){
+        phases[p] = -1;
+    }
+    for(int i = 0; i < count; i++){
+        double start = steps[i].after == START ? 0 : done[steps[i].after];
+        done[i] = start + steps[i].duration;
+        if(steps[i].phase >= 0){
+            phases[steps[i].phase] = done[i];
+        }
+    }
+}
+
+/**
+ * @brief Boot from before the change
+ * @details setup() waits for Serial, brings up the soft AP and web
+ *          server, then creates the tasks. The balance task starts the
+ *          IMU, which waits 100 ms, then waits another 100 ms before its
+ *          first read. There is no saved settings load and the
+ *          controller runs on the first sample.
+ *
+ * @param t Times
+ * @param phases Time each phase is reached in ms
+ */
+void serial_boot(const BootTimes& t, double* phases){
+    double wait = t.task_wait > t.report ? t.task_wait : t.report;
+    Step steps[] = {
+        {-1, t.serial, START},              // 0 Serial
+        {WIFI_READY, t.wifi, 0},            // 1 soft AP
+        {SERVER_READY, t.server, 1},        // 2 web server
+        {TASKS, t.tasks, 2},                // 3 tasks
+        {IMU_READY, t.imu + t.imu_wait, 3}, // 4 IMU start
+        {FIRST_SAMPLE, wait, 4},            // 5 first read
+        {BALANCING, 0, 5}                   // 6 controller on
+    };
+    run(steps, sizeof(steps) / sizeof(steps[0]), phases);
+}
+
+/**
+ * @brief Boot after the change
+ * @details setup() loads the settings and creates the tasks. The
+ *          balance task starts the IMU while the network task brings up
+ *          the soft AP and web server. The controller is turned on once
+ *          the bike has been held upright for the arm time, so the bike
+ *          is taken to be upright from power on.
+ *
+ * @param t Times
+ * @param phases Time each phase is reached in ms
+ */
+void parallel_boot(const BootTimes& t, double* phases){
+    Step steps[] = {
+        {CONFIG, t.config, START},          // 0 load settings
+        {TASKS, t.tasks, 0},                // 1 tasks
+        {IMU_READY, t.imu, 1},              // 2 IMU start
+        {FIRST_SAMPLE, t.report, 2},        // 3 first read
+        {BALANCING, t.arm, 3},              // 4 upright hold
+        {WIFI_READY, t.wifi, 1},            // 5 soft AP
+        {SERVER_READY, t.server, 5}         // 6 web server
+    };
+    run(steps, sizeof(steps) / sizeof(steps[0]), phases);
+}
+
+/**
+ * @brief Prints one phase time, or - if the boot does not have it
+ *
+ * @param ms Time in ms
+ */
+void print_time(double ms){
+    if(ms < 0){
+        printf(" %10s", "-");
+    }else{
+        printf(" %10.1f", ms);
+    }
+}
+
+/**
+ * @brief Prints how to use the program
+ */
+void usage(const BootTimes& t){
+    fprintf(stderr,
+            "usage: boot_sim [options], times in ms\n"
+            "  -serial %g  -config %g  -tasks %g  -imu %g  -report %g\n"
+            "  -wifi %g  -server %g  -arm %g  -imu_wait %g  -task_wait %g\n",
+            t.serial, t.config, t.tasks, t.imu, t.report, t.wifi, t.server,
+            t.arm, t.imu_wait, t.task_wait);
+}
+
+int main(int argc, char** argv){
+    // The Feather uses a USB to UART chip, so while(!Serial) never waits
+    BootTimes t = {0, 3, 1, 60, 2.5, 300, 2, 250, 100, 100};
+    for(int i = 1; i < argc; i++){
+        const char* opt = argv[i];
+        if(strcmp(opt, "-h") == 0 || i + 1 >= argc){
+            usage(t);
+            return strcmp(opt, "-h") == 0 ? 0 : 1;
+        }
+        double v = atof(argv[++i]);
+        if(strcmp(opt, "-serial") == 0) t.serial = v;
+        else if(strcmp(opt, "-config") == 0) t.config = v;
+        else if(strcmp(opt, "-tasks") == 0) t.tasks = v;
+        else if(strcmp(opt, "-imu") == 0) t.imu = v;
+        else if(strcmp(opt, "-report") == 0) t.report = v;
+        else if(strcmp(opt, "-wifi") == 0) t.wifi = v;
+        else if(strcmp(opt, "-server") == 0) t.server = v;
+        else if(strcmp(opt, "-arm") == 0) t.arm = v;
+        else if(strcmp(opt, "-imu_wait") == 0) t.imu_wait = v;
+        else if(strcmp(opt, "-task_wait") == 0) t.task_wait = v;
+        else{
+            usage(t);
+            return 1;
+        }
+    }
+
+    double before[PHASES], after[PHASES];
+    serial_boot(t, before);
+    parallel_boot(t, after);
+    printf("%-14s %10s %10s %10s\n", "phase (ms)", "serial", "parallel", "change");
+    for(int p = 0; p < PHASES; p++){
+        printf("%-14s", phase_names[p]);
+        print_time(before[p]);
+        print_time(after[p]);
+        if(before[p] >= 0 && after[p] >= 0){
+            printf(" %+10.1f\n", after[p] - before[p]);
+        }else{
+            printf(" %10s\n", "-");
+        }
+    }
+
+    // Balancing no longer waits on the WiFi, so show it against the soft AP
+    printf("\nfirst sample against soft AP time:\n");
+    printf("%-14s %10s %10s\n", "wifi (ms)", "serial", "parallel");
+    for(double wifi = 100; wifi <= 1000; wifi += 300){
+        BootTimes sweep = t;
+        sweep.wifi = wifi;
+        serial_boot(sweep, before);
+        parallel_boot(sweep, after);
+        printf("%-14.0f", wifi);
+        print_time(before[FIRST_SAMPLE]);
+        print_time(after[FIRST_SAMPLE]);
+        printf("\n");
+    }
+    return 0;
+}
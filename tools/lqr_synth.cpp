@@ -0,0 +1,502 @@
+/**
+ * @file lqr_synth.cpp
+ *
+ * This file is a program that is ran on a computer to find the gains for
+ * the LQR_Controller. The bike is modeled as an inverted pendulum with a
+ * reaction wheel driven by a DC motor, with the states tilt, tilt rate
+ * and wheel speed. The model is turned into a discrete model at the
+ * balance period, the discrete Riccati equation is solved by iterating
+ * it until it stops changing, and the gains are written to
+ * src/LQR_Gains.h as constexpr values. The same discrete model is also
+ * written out so the bike can estimate the wheel speed, since there is
+ * no encoder on the wheel.
+ *
+ * The program then simulates the bike falling from a starting tilt with
+ * the new gains and with the PID law from PID_Controller::run, and
+ * prints the recovery time and motor effort of each. With -jitter the
+ * time each command is applied moves around inside the period, like the
+ * balance task waking on time and then waiting a varying time for the
+ * IMU, while the controllers still assume the exact period.
+ *
+ * Build and run with:
+ *     g++ -O2 -std=c++11 -o lqr_synth tools/lqr_synth.cpp
+ *     ./lqr_synth -o src/LQR_Gains.h
+ *
+ * Every model value can be changed on the command line, run with -h to
+ * see them. The model values should be checked against a frequency
+ * response test from tools/sysid_bode.cpp before trusting the gains.
+ *
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define STATES 3
+#define SETTLE_TILT 0.0087
+#define SETTLE_HOLD 0.5
+
+/**
+ * @brief Model of the bike and the weights for the LQR
+ */
+struct Model{
+    double mass;        ///< Mass of the bike in kg
+    double height;      ///< Height of the center of mass in m
+    double body_inertia;///< Inertia of the bike about the ground in kg m^2
+    double wheel_inertia;///< Inertia of the reaction wheel in kg m^2
+    double kt;          ///< Motor torque constant in Nm/A
+    double ke;          ///< Motor back EMF constant in V s/rad
+    double resistance;  ///< Motor resistance in ohm
+    double voltage;     ///< Motor supply voltage at 100% PWM
+    double period;      ///< Balance period in s
+    double max_tilt;    ///< Tilt weight, 1 / max_tilt^2
+    double max_rate;    ///< Tilt rate weight, 1 / max_rate^2
+    double max_wheel;   ///< Wheel speed weight, 1 / max_wheel^2
+    double max_pwm;     ///< PWM weight, 1 / max_pwm^2
+    double jitter;      ///< Largest delay from the start of a period to the command in s
+};
+
+typedef double Mat[STATES][STATES];
+typedef double Vec[STATES];
+
+/**
+ * @brief Builds the continuous model
+ * @details With the motor torque t = cu u - cw w,
+ *          Ib tilt'' = m g l tilt - t
+ *          Iw (tilt'' + w') = t
+ *          where w is the wheel speed relative to the bike and u is the
+ *          PWM in percent. A positive PWM pushes the bike back towards
+ *          upright when the tilt is positive, the same as the PID.
+ *
+ * @param m Model
+ * @param a State matrix
+ * @param b Input matrix
+ */
+void continuous(const Model& m, Mat a, Vec b){
+    double mgl = m.mass * 9.81 * m.height;
+    double cu = m.kt * m.voltage / (100 * m.resistance);
+    double cw = m.kt * m.ke / m.resistance;
+    double both = 1 / m.wheel_inertia + 1 / m.body_inertia;
+    double values[STATES][STATES] = {
+        {0, 1, 0},
+        {mgl / m.body_inertia, 0, cw / m.body_inertia},
+        {-mgl / m.body_inertia, 0, -cw * both}
+    };
+    memcpy(a, values, sizeof(values));
+    b[0] = 0;
+    b[1] = -cu / m.body_inertia;
+    b[2] = cu * both;
+}
+
+/**
+ * @brief Turns the continuous model into a discrete one
+ * @details Uses a zero order hold, found from the matrix exponential of
+ *          [[A B] [0 0]] * T by its power series.
+ *
+ * @param a Continuous state matrix
+ * @param b Continuous input matrix
+ * @param t Period in s
+ * @param ad Discrete state matrix
+ * @param bd Discrete input matrix
+ */
+void discretize(Mat a, Vec b, double t, Mat ad, Vec bd){
+    const int n = STATES + 1;
+    double m[n][n] = {};
+    for(int i = 0; i < STATES; i++){
+        for(int j = 0; j < STATES; j++){
+            m[i][j] = a[i][j] * t;
+        }
+        m[i][STATES] = b[i] * t;
+    }
+    double sum[n][n] = {};
+    double term[n][n] = {};
+    for(int i = 0; i < n; i++){
+        sum[i][i] = 1;
+        term[i][i] = 1;
+    }
+    for(int k = 1; k < 30; k++){
+        double next[n][n] = {};
+        for(int i = 0; i < n; i++){
+            for(int j = 0; j < n; j++){
+                for(int l = 0; l < n; l++){
+                    next[i][j] += term[i][l] * m[l][j];
+                }
+                next[i][j] /= k;
+            }
+        }
+        memcpy(term, next, sizeof(term));
+        for(int i = 0; i < n; i++){
+            for(int j = 0; j < n; j++){
+                sum[i][j] += term[i][j];
+            }
+        }
+    }
+    for(int i = 0; i < STATES; i++){
+        for(int j = 0; j < STATES; j++){
+            ad[i][j] = sum[i][j];
+        }
+        bd[i] = sum[i][STATES];
+    }
+}
+
+/**
+ * @brief Solves the discrete Riccati equation for the LQR gains
+ * @details Iterates P = Q + A'PA - A'PB (R + B'PB)^-1 B'PA until it
+ *          stops changing. The gains are returned as u = k . x, which
+ *          is the negative of the usual u = -Kx.
+ *
+ * @param ad Discrete state matrix
+ * @param bd Discrete input matrix
+ * @param q State weights
+ * @param r Input weight
+ * @param k Gains
+ * @return true if it converged
+ */
+bool dare(Mat ad, Vec bd, Vec q, double r, Vec k){
+    Mat p = {};
+    for(int i = 0; i < STATES; i++){
+        p[i][i] = q[i];
+    }
+    for(int iter = 0; iter < 200000; iter++){
+        // pb = P B, bpb = B'PB, pa = B'PA
+        Vec pb = {};
+        for(int i = 0; i < STATES; i++){
+            for(int j = 0; j < STATES; j++){
+                pb[i] += p[i][j] * bd[j];
+            }
+        }
+        double bpb = 0;
+        for(int i = 0; i < STATES; i++){
+            bpb += bd[i] * pb[i];
+        }
+        Vec bpa = {};
+        for(int j = 0; j < STATES; j++){
+            for(int i = 0; i < STATES; i++){
+                bpa[j] += pb[i] * ad[i][j];
+            }
+        }
+        Mat apa = {};
+        for(int i = 0; i < STATES; i++){
+            for(int j = 0; j < STATES; j++){
+                for(int l = 0; l < STATES; l++){
+                    for(int s = 0; s < STATES; s++){
+                        apa[i][j] += ad[l][i] * p[l][s] * ad[s][j];
+                    }
+                }
+            }
+        }
+        double change = 0;
+        double size = 0;
+        Mat next;
+        for(int i = 0; i < STATES; i++){
+            for(int j = 0; j < STATES; j++){
+                next[i][j] = apa[i][j] - bpa[i] * bpa[j] / (r + bpb) + (i == j ? q[i] : 0);
+            }
+        }
+        // Rounding makes P drift away from symmetric, which lets it blow
+        // up, so it is made symmetric again every step
+        for(int i = 0; i < STATES; i++){
+            for(int j = 0; j < i; j++){
+                next[i][j] = next[j][i] = (next[i][j] + next[j][i]) / 2;
+            }
+        }
+        for(int i = 0; i < STATES; i++){
+            for(int j = 0; j < STATES; j++){
+                change += fabs(next[i][j] - p[i][j]);
+                size += fabs(next[i][j]);
+            }
+        }
+        if(!isfinite(size)){
+            return false;
+        }
+        memcpy(p, next, sizeof(p));
+        if(change <= 1e-12 * size){
+            for(int i = 0; i < STATES; i++){
+                k[i] = -bpa[i] / (r + bpb);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Results of one simulation
+ */
+struct SimResult{
+    bool fell;          ///< Went past the fall angle
+    double recovery;    ///< Time it entered the settle tilt and stayed for SETTLE_HOLD in s, -1 if never
+    double effort;      ///< Integral of PWM squared in %^2 s
+    double abs_effort;  ///< Integral of |PWM| in % s
+    double peak;        ///< Largest PWM after saturation
+    double wheel;       ///< Wheel speed at the end in rad/s
+};
+
+/**
+ * @brief The PID law from PID_Controller::run
+ * @details Kept the same as the one on the bike, including the setpoint
+ *          dithering and the integral saturation.
+ */
+struct PidLaw{
+    double kp, ki, kd, setpoint, total_error, prev_error;
+    double run(double angle){
+        double val = -angle;
+        double error = setpoint - val;
+        total_error += error;
+        double sat = 50 / ki;
+        setpoint += error < 0 ? -0.0002 : 0.0002;
+        if(total_error >= sat){
+            total_error = sat;
+        }else if(total_error <= -sat){
+            total_error = -sat;
+        }
+        double out = kp * error + ki * total_error + kd * (error - prev_error);
+        prev_error = error;
+        return out;
+    }
+};
+
+/**
+ * @brief Simulates the bike starting at a tilt
+ * @details The model is stepped with the nonlinear gravity term and the
+ *          PWM saturates at +/-100 like the MotorDriver. With LQR the
+ *          wheel speed is estimated from the discrete model the same way
+ *          as LQR_Controller does. The bike has recovered once the tilt
+ *          stays within SETTLE_TILT for SETTLE_HOLD, and the recovery
+ *          time is when it entered and stayed. If the hold does not fit
+ *          in the time simulated it never settled, so the result does
+ *          not change with the length of the simulation. Each command is
+ *          applied a random time between 0 and the jitter after the
+ *          start of its period and held until the next one, so a step
+ *          lasts the period plus the change in that delay. The random
+ *          numbers start from the same seed every run so PID and LQR see
+ *          the same timing.
+ *
+ * @param m Model
+ * @param use_lqr True for LQR, false for PID
+ * @param k LQR gains
+ * @param ad Discrete state matrix for the wheel speed estimate
+ * @param bd Discrete input matrix for the wheel speed estimate
+ * @param pid PID law
+ * @param tilt0 Starting tilt in rad
+ * @param duration Time to simulate in s
+ * @return SimResult
+ */
+SimResult simulate(const Model& m, bool use_lqr, Vec k, Mat ad, Vec bd, PidLaw pid, double tilt0, double duration){
+    const int sub = 20;
+    double mgl = m.mass * 9.81 * m.height;
+    double cu = m.kt * m.voltage / (100 * m.resistance);
+    double cw = m.kt * m.ke / m.resistance;
+    double tilt = tilt0, rate = 0, wheel = 0, wheel_est = 0;
+    SimResult res = {false, -1, 0, 0, 0, 0};
+    int steps = (int)lround(duration / m.period);
+    int hold_steps = (int)lround(SETTLE_HOLD / m.period);
+    int inside = 0;
+    srand(1);
+    double delay = m.jitter * rand() / RAND_MAX;
+    for(int n = 0; n < steps; n++){
+        double u;
+        if(use_lqr){
+            u = k[0] * tilt + k[1] * rate + k[2] * wheel_est;
+        }else{
+            u = pid.run(tilt);
+        }
+        u = u > 100 ? 100 : (u < -100 ? -100 : u);
+        if(use_lqr){
+            wheel_est = ad[2][0] * tilt + ad[2][1] * rate + ad[2][2] * wheel_est + bd[2] * u;
+        }
+        double next_delay = m.jitter * rand() / RAND_MAX;
+        double step = m.period + next_delay - delay;
+        delay = next_delay;
+        double dt = step / sub;
+        for(int s = 0; s < sub; s++){
+            double torque = cu * u - cw * wheel;
+            double acc = (mgl * sin(tilt) - torque) / m.body_inertia;
+            double wheel_acc = torque / m.wheel_inertia - acc;
+            tilt += rate * dt;
+            rate += acc * dt;
+            wheel += wheel_acc * dt;
+        }
+        res.effort += u * u * step;
+        res.abs_effort += fabs(u) * step;
+        if(fabs(u) > res.peak){
+            res.peak = fabs(u);
+        }
+        if(fabs(tilt) > 0.35){
+            res.fell = true;
+            break;
+        }
+        // The tilt here is the value at the end of step n
+        inside = fabs(tilt) > SETTLE_TILT ? 0 : inside + 1;
+        if(inside == hold_steps && res.recovery < 0){
+            res.recovery = (n + 2 - hold_steps) * m.period;
+        }
+    }
+    if(res.fell){
+        res.recovery = -1;
+    }
+    res.wheel = wheel;
+    return res;
+}
+
+/**
+ * @brief Prints one simulation result
+ *
+ * @param name Controller name
+ * @param r Result
+ */
+void print_result(const char* name, const SimResult& r){
+    if(r.fell){
+        printf("  %-4s fell over          effort %9.1f %%^2s  |u| %7.2f %%s  peak %5.1f %%\n",
+               name, r.effort, r.abs_effort, r.peak);
+    }else if(r.recovery < 0){
+        printf("  %-4s never settles      effort %9.1f %%^2s  |u| %7.2f %%s  peak %5.1f %%  wheel %7.1f rad/s\n",
+               name, r.effort, r.abs_effort, r.peak, r.wheel);
+    }else{
+        printf("  %-4s recovers in %6.3f s  effort %9.1f %%^2s  |u| %7.2f %%s  peak %5.1f %%  wheel %7.1f rad/s\n",
+               name, r.recovery, r.effort, r.abs_effort, r.peak, r.wheel);
+    }
+}
+
+/**
+ * @brief Prints how to use the program
+ */
+void usage(const Model& m){
+    fprintf(stderr,
+            "usage: lqr_synth [-o header] [options]\n"
+            "  -mass %g  -height %g  -body %g  -wheel %g\n"
+            "  -kt %g  -ke %g  -res %g  -volt %g  -period %g\n"
+            "  -qtilt %g  -qrate %g  -qwheel %g  -rpwm %g  -jitter %g\n"
+            "  -kp 225  -ki 0.1  -kd 1000  -tilt 0.05,0.1,0.15  -time 5\n",
+            m.mass, m.height, m.body_inertia, m.wheel_inertia, m.kt, m.ke,
+            m.resistance, m.voltage, m.period, m.max_tilt, m.max_rate,
+            m.max_wheel, m.max_pwm, m.jitter);
+}
+
+int main(int argc, char** argv){
+    // The weights keep the tilt gain low enough that the PWM does not
+    // saturate until about 9 deg, so IMU noise near upright is not turned
+    // into full motor swings
+    Model m = {0.5, 0.05, 0.002, 2e-4, 0.03, 0.02, 1.2, 12.0, 0.001,
+               0.2, 2.0, 300.0, 100.0, 0};
+    PidLaw pid = {225, 0.1, 1000, 0, 0, 0};
+    const char* out = NULL;
+    double tilts[8] = {0.05, 0.1, 0.15};
+    int num_tilts = 3;
+    double duration = 5;
+    for(int i = 1; i < argc; i++){
+        const char* opt = argv[i];
+        if(strcmp(opt, "-h") == 0 || i + 1 >= argc){
+            usage(m);
+            return strcmp(opt, "-h") == 0 ? 0 : 1;
+        }
+        const char* val = argv[++i];
+        double v = atof(val);
+        if(strcmp(opt, "-o") == 0) out = val;
+        else if(strcmp(opt, "-mass") == 0) m.mass = v;
+        else if(strcmp(opt, "-height") == 0) m.height = v;
+        else if(strcmp(opt, "-body") == 0) m.body_inertia = v;
+        else if(strcmp(opt, "-wheel") == 0) m.wheel_inertia = v;
+        else if(strcmp(opt, "-kt") == 0) m.kt = v;
+        else if(strcmp(opt, "-ke") == 0) m.ke = v;
+        else if(strcmp(opt, "-res") == 0) m.resistance = v;
+        else if(strcmp(opt, "-volt") == 0) m.voltage = v;
+        else if(strcmp(opt, "-period") == 0) m.period = v;
+        else if(strcmp(opt, "-qtilt") == 0) m.max_tilt = v;
+        else if(strcmp(opt, "-qrate") == 0) m.max_rate = v;
+        else if(strcmp(opt, "-qwheel") == 0) m.max_wheel = v;
+        else if(strcmp(opt, "-rpwm") == 0) m.max_pwm = v;
+        else if(strcmp(opt, "-jitter") == 0) m.jitter = v;
+        else if(strcmp(opt, "-kp") == 0) pid.kp = v;
+        else if(strcmp(opt, "-ki") == 0) pid.ki = v;
+        else if(strcmp(opt, "-kd") == 0) pid.kd = v;
+        else if(strcmp(opt, "-time") == 0) duration = v;
+        else if(strcmp(opt, "-tilt") == 0){
+            num_tilts = 0;
+            char* end = (char*)val;
+            while(*end != '\0' && num_tilts < 8){
+                tilts[num_tilts++] = strtod(end, &end);
+                if(*end == ','){
+                    end++;
+                }
+            }
+        }else{
+            usage(m);
+            return 1;
+        }
+    }
+
+    Mat a, ad;
+    Vec b, bd, k;
+    continuous(m, a, b);
+    discretize(a, b, m.period, ad, bd);
+    Vec q = {1 / (m.max_tilt * m.max_tilt), 1 / (m.max_rate * m.max_rate),
+             1 / (m.max_wheel * m.max_wheel)};
+    double r = 1 / (m.max_pwm * m.max_pwm);
+    if(!dare(ad, bd, q, r, k)){
+        fprintf(stderr, "Riccati equation did not converge\n");
+        return 1;
+    }
+    printf("LQR gains: tilt %.4f  rate %.4f  wheel %.6f\n", k[0], k[1], k[2]);
+
+    if(out != NULL){
+        FILE* file = fopen(out, "w");
+        if(file == NULL){
+            perror(out);
+            return 1;
+        }
+        fprintf(file,
+                "/**\n"
+                " * @file LQR_Gains.h\n"
+                " * \n"
+                " * This file holds the gains for the LQR_Controller and the discrete\n"
+                " * model used to estimate the wheel speed. It is made by\n"
+                " * tools/lqr_synth.cpp, so change the model there and run it again\n"
+                " * instead of changing this file.\n"
+                " * \n"
+                " * Model: mass %g kg, height %g m, body inertia %g kg m^2,\n"
+                " *        wheel inertia %g kg m^2, kt %g Nm/A, ke %g V s/rad,\n"
+                " *        resistance %g ohm, supply %g V, period %g s\n"
+                " * Weights: tilt %g rad, rate %g rad/s, wheel %g rad/s, pwm %g %%\n"
+                " * \n"
+                " * @author Termprojet contributors\n"
+                " * \n"
+                " */\n"
+                "#ifndef LQR_Gains_h\n"
+                "#define LQR_Gains_h\n"
+                "\n"
+                "//Balance period the gains were made for in seconds\n"
+                "constexpr float LQR_PERIOD = %.9gf;\n"
+                "\n"
+                "//PWM = K_TILT * tilt + K_RATE * rate + K_WHEEL * wheel speed\n"
+                "constexpr float LQR_K_TILT = %.9gf;\n"
+                "constexpr float LQR_K_RATE = %.9gf;\n"
+                "constexpr float LQR_K_WHEEL = %.9gf;\n"
+                "\n"
+                "//Next wheel speed = TILT * tilt + RATE * rate + WHEEL * wheel speed + PWM * pwm\n"
+                "constexpr float LQR_WHEEL_TILT = %.9gf;\n"
+                "constexpr float LQR_WHEEL_RATE = %.9gf;\n"
+                "constexpr float LQR_WHEEL_WHEEL = %.9gf;\n"
+                "constexpr float LQR_WHEEL_PWM = %.9gf;\n"
+                "\n"
+                "#endif\n",
+                m.mass, m.height, m.body_inertia, m.wheel_inertia, m.kt, m.ke,
+                m.resistance, m.voltage, m.period, m.max_tilt, m.max_rate,
+                m.max_wheel, m.max_pwm, m.period, k[0], k[1], k[2],
+                ad[2][0], ad[2][1], ad[2][2], bd[2]);
+        fclose(file);
+        printf("Wrote %s\n", out);
+    }
+
+    printf("Recovery from a starting tilt, settled is within %.1f deg for %.1f s,\n"
+           "commands up to %.3f ms late:\n",
+           SETTLE_TILT * 180 / M_PI, SETTLE_HOLD, m.jitter * 1000);
+    for(int i = 0; i < num_tilts; i++){
+        printf("tilt %.3f rad\n", tilts[i]);
+        print_result("PID", simulate(m, false, k, ad, bd, pid, tilts[i], duration));
+        print_result("LQR", simulate(m, true, k, ad, bd, pid, tilts[i], duration));
+    }
+    return 0;
+}
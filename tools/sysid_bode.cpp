@@ -0,0 +1,536 @@
+/**
+ * @file sysid_bode.cpp
+ *
+ * This file is a program that is ran on a computer to find the frequency
+ * response of the balance loop from a test recorded with the /sysid page.
+ * The CSV from /sysidData is read one line at a time and split into
+ * overlapping windows that are each put through an FFT and averaged
+ * (Welch's method), so a capture of any length only needs memory for
+ * one window. Since the test signal is added after the controller, the
+ * plant (motor command to angle) is found from angle/signal divided by
+ * command/signal, and the loop gain from signal/command - 1. An ARX
+ * model of the plant is also fit by least squares as the data streams in.
+ *
+ * Build and run with:
+ *     g++ -O2 -std=c++11 -o sysid_bode tools/sysid_bode.cpp
+ *     ./sysid_bode capture.csv -n 512 -a 2 -b 2 > bode.csv
+ *
+ * The output is CSV with one line per frequency and can be plotted
+ * with any spreadsheet or plotting program. The fitted model and the
+ * loop margins are printed to stderr. The loop phase is unwrapped so it
+ * can go past -180 deg without jumping. Only frequencies where the
+ * coherence is high are trusted for the margins, so sweep the chirp
+ * past the crossover.
+ *
+ * The recorded command is before the motor driver saturates at
+ * +/-100, so keep the test amplitude small enough that it does not.
+ *
+ * @author Termprojet contributors
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+
+typedef std::complex<double> cplx;
+
+//Bins with less coherence than this are not used for the margins
+#define MIN_COHERENCE 0.8
+
+/**
+ * @brief In place radix 2 FFT
+ *
+ * @param data Values to transform, the size must be a power of 2
+ */
+void fft(std::vector<cplx>& data){
+    size_t n = data.size();
+    for(size_t i = 1, j = 0; i < n; i++){
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1){
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j){
+            std::swap(data[i], data[j]);
+        }
+    }
+    for(size_t len = 2; len <= n; len <<= 1){
+        cplx w_len = std::polar(1.0, -2 * M_PI / len);
+        for(size_t i = 0; i < n; i += len){
+            cplx w = 1;
+            for(size_t k = 0; k < len / 2; k++){
+                cplx a = data[i + k];
+                cplx b = data[i + k + len / 2] * w;
+                data[i + k] = a + b;
+                data[i + k + len / 2] = a - b;
+                w *= w_len;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Averaged cross spectra of the signal, command and angle
+ */
+class Spectra{
+    private:
+        size_t nfft;
+        std::vector<double> window;
+        std::vector<double> d_buf;
+        std::vector<double> u_buf;
+        std::vector<double> y_buf;
+        size_t filled;
+        size_t since_last;
+    public:
+        std::vector<double> s_dd;
+        std::vector<double> s_uu;
+        std::vector<double> s_yy;
+        std::vector<cplx> s_ud;
+        std::vector<cplx> s_yd;
+        size_t segments;
+
+        Spectra(size_t n);
+        void add(double d, double u, double y);
+    private:
+        void process();
+};
+
+/**
+ * @brief Construct a new Spectra object
+ *
+ * @param n Window length, must be a power of 2
+ */
+Spectra::Spectra(size_t n)
+    : nfft(n), window(n), d_buf(n), u_buf(n), y_buf(n), filled(0), since_last(0),
+      s_dd(n / 2 + 1), s_uu(n / 2 + 1), s_yy(n / 2 + 1), s_ud(n / 2 + 1), s_yd(n / 2 + 1),
+      segments(0){
+    for(size_t i = 0; i < n; i++){
+        window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / n);
+    }
+}
+
+/**
+ * @brief Adds one sample
+ * @details Windows overlap by half, so a new window is processed every
+ *          nfft / 2 samples once the first one is full.
+ *
+ * @param d Added signal
+ * @param u Motor command
+ * @param y Angle
+ */
+void Spectra::add(double d, double u, double y){
+    // Shift register of the last nfft samples, the oldest is at 0
+    if(filled < nfft){
+        d_buf[filled] = d;
+        u_buf[filled] = u;
+        y_buf[filled] = y;
+        filled++;
+        if(filled == nfft){
+            process();
+        }
+        return;
+    }
+    memmove(&d_buf[0], &d_buf[1], (nfft - 1) * sizeof(double));
+    memmove(&u_buf[0], &u_buf[1], (nfft - 1) * sizeof(double));
+    memmove(&y_buf[0], &y_buf[1], (nfft - 1) * sizeof(double));
+    d_buf[nfft - 1] = d;
+    u_buf[nfft - 1] = u;
+    y_buf[nfft - 1] = y;
+    since_last++;
+    if(since_last == nfft / 2){
+        process();
+    }
+}
+
+/**
+ * @brief Adds the current window to the averaged spectra
+ */
+void Spectra::process(){
+    std::vector<cplx> d_f(nfft), u_f(nfft), y_f(nfft);
+    double d_mean = 0, u_mean = 0, y_mean = 0;
+    for(size_t i = 0; i < nfft; i++){
+        d_mean += d_buf[i];
+        u_mean += u_buf[i];
+        y_mean += y_buf[i];
+    }
+    d_mean /= nfft;
+    u_mean /= nfft;
+    y_mean /= nfft;
+    for(size_t i = 0; i < nfft; i++){
+        d_f[i] = (d_buf[i] - d_mean) * window[i];
+        u_f[i] = (u_buf[i] - u_mean) * window[i];
+        y_f[i] = (y_buf[i] - y_mean) * window[i];
+    }
+    fft(d_f);
+    fft(u_f);
+    fft(y_f);
+    for(size_t k = 0; k <= nfft / 2; k++){
+        s_dd[k] += std::norm(d_f[k]);
+        s_uu[k] += std::norm(u_f[k]);
+        s_yy[k] += std::norm(y_f[k]);
+        s_ud[k] += u_f[k] * std::conj(d_f[k]);
+        s_yd[k] += y_f[k] * std::conj(d_f[k]);
+    }
+    segments++;
+    since_last = 0;
+}
+
+/**
+ * @brief Least squares ARX model fit one sample at a time
+ * @details Fits y[k] = -a1 y[k-1] - ... - a_na y[k-na]
+ *                      + b1 u[k-1] + ... + b_nb u[k-nb]
+ *          by adding up the normal equations, so memory does not grow
+ *          with the capture.
+ */
+class ArxFit{
+    private:
+        size_t na;
+        size_t nb;
+        std::vector<double> y_hist;
+        std::vector<double> u_hist;
+        std::vector<double> r;
+        std::vector<double> rhs;
+        size_t seen;
+    public:
+        std::vector<double> a;
+        std::vector<double> b;
+
+        ArxFit(size_t num_a, size_t num_b);
+        void add(double u, double y);
+        bool solve();
+        cplx response(double w);
+};
+
+/**
+ * @brief Construct a new ArxFit object
+ *
+ * @param num_a Number of denominator terms
+ * @param num_b Number of numerator terms
+ */
+ArxFit::ArxFit(size_t num_a, size_t num_b)
+    : na(num_a), nb(num_b), y_hist(num_a), u_hist(num_b),
+      r((num_a + num_b) * (num_a + num_b)), rhs(num_a + num_b), seen(0),
+      a(num_a), b(num_b){
+}
+
+/**
+ * @brief Adds one sample to the fit
+ *
+ * @param u Motor command
+ * @param y Angle
+ */
+void ArxFit::add(double u, double y){
+    size_t n = na + nb;
+    if(seen >= (na > nb ? na : nb)){
+        std::vector<double> phi(n);
+        for(size_t i = 0; i < na; i++){
+            phi[i] = -y_hist[i];
+        }
+        for(size_t i = 0; i < nb; i++){
+            phi[na + i] = u_hist[i];
+        }
+        for(size_t i = 0; i < n; i++){
+            for(size_t j = 0; j < n; j++){
+                r[i * n + j] += phi[i] * phi[j];
+            }
+            rhs[i] += phi[i] * y;
+        }
+    }
+    for(size_t i = na; i > 1; i--){
+        y_hist[i - 1] = y_hist[i - 2];
+    }
+    for(size_t i = nb; i > 1; i--){
+        u_hist[i - 1] = u_hist[i - 2];
+    }
+    if(na > 0){
+        y_hist[0] = y;
+    }
+    if(nb > 0){
+        u_hist[0] = u;
+    }
+    seen++;
+}
+
+/**
+ * @brief Solves the normal equations for the model
+ *
+ * @return true if the equations could be solved
+ */
+bool ArxFit::solve(){
+    size_t n = na + nb;
+    std::vector<double> m = r;
+    std::vector<double> x = rhs;
+    for(size_t col = 0; col < n; col++){
+        size_t pivot = col;
+        for(size_t row = col + 1; row < n; row++){
+            if(fabs(m[row * n + col]) > fabs(m[pivot * n + col])){
+                pivot = row;
+            }
+        }
+        if(fabs(m[pivot * n + col]) < 1e-12){
+            return false;
+        }
+        for(size_t j = 0; j < n; j++){
+            std::swap(m[col * n + j], m[pivot * n + j]);
+        }
+        std::swap(x[col], x[pivot]);
+        for(size_t row = col + 1; row < n; row++){
+            double f = m[row * n + col] / m[col * n + col];
+            for(size_t j = col; j < n; j++){
+                m[row * n + j] -= f * m[col * n + j];
+            }
+            x[row] -= f * x[col];
+        }
+    }
+    for(size_t col = n; col-- > 0;){
+        for(size_t j = col + 1; j < n; j++){
+            x[col] -= m[col * n + j] * x[j];
+        }
+        x[col] /= m[col * n + col];
+    }
+    for(size_t i = 0; i < na; i++){
+        a[i] = x[i];
+    }
+    for(size_t i = 0; i < nb; i++){
+        b[i] = x[na + i];
+    }
+    return true;
+}
+
+/**
+ * @brief Frequency response of the fitted model
+ *
+ * @param w Frequency in radians per sample
+ * @return cplx
+ */
+cplx ArxFit::response(double w){
+    cplx num = 0;
+    cplx den = 1;
+    for(size_t i = 0; i < nb; i++){
+        num += b[i] * std::polar(1.0, -w * (i + 1));
+    }
+    for(size_t i = 0; i < na; i++){
+        den += a[i] * std::polar(1.0, -w * (i + 1));
+    }
+    return num / den;
+}
+
+/**
+ * @brief Finds the roots of z^n + c[0] z^(n-1) + ... + c[n-1]
+ * @details Uses the Durand-Kerner method, which is plenty for the
+ *          small model orders used here.
+ *
+ * @param c Polynomial coefficients after the leading 1
+ * @return std::vector<cplx>
+ */
+std::vector<cplx> roots(const std::vector<double>& c){
+    size_t n = c.size();
+    std::vector<cplx> z(n);
+    for(size_t i = 0; i < n; i++){
+        z[i] = std::pow(cplx(0.4, 0.9), (double)i);
+    }
+    for(int iter = 0; iter < 500; iter++){
+        for(size_t i = 0; i < n; i++){
+            cplx p = 1;
+            for(size_t k = 0; k < n; k++){
+                p = p * z[i] + c[k];
+            }
+            cplx q = 1;
+            for(size_t j = 0; j < n; j++){
+                if(j != i){
+                    q *= z[i] - z[j];
+                }
+            }
+            z[i] -= p / q;
+        }
+    }
+    return z;
+}
+
+/**
+ * @brief Phase of a complex value in degrees
+ *
+ * @param v Value
+ * @return double
+ */
+double phase_deg(cplx v){
+    return std::arg(v) * 180 / M_PI;
+}
+
+/**
+ * @brief Moves a phase by whole turns to be closest to another phase
+ * @details arg() only gives -180 to 180 deg, so a loop phase that runs
+ *          past -180 jumps to +180. Unwrapping against the phase of the
+ *          bin before keeps the phase continuous.
+ *
+ * @param phase Phase in degrees
+ * @param near Phase to be closest to in degrees
+ * @return double
+ */
+double unwrap_deg(double phase, double near){
+    return phase + 360 * round((near - phase) / 360);
+}
+
+/**
+ * @brief Magnitude of a complex value in dB
+ *
+ * @param v Value
+ * @return double
+ */
+double mag_db(cplx v){
+    return 20 * log10(std::abs(v) + 1e-300);
+}
+
+/**
+ * @brief Prints how to use the program
+ */
+void usage(){
+    fprintf(stderr, "usage: sysid_bode capture.csv [-n nfft] [-a na] [-b nb]\n");
+}
+
+int main(int argc, char** argv){
+    const char* path = NULL;
+    size_t nfft = 512;
+    size_t na = 2;
+    size_t nb = 2;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc){
+            nfft = strtoul(argv[++i], NULL, 10);
+        }else if(strcmp(argv[i], "-a") == 0 && i + 1 < argc){
+            na = strtoul(argv[++i], NULL, 10);
+        }else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc){
+            nb = strtoul(argv[++i], NULL, 10);
+        }else if(path == NULL){
+            path = argv[i];
+        }else{
+            usage();
+            return 1;
+        }
+    }
+    if(path == NULL || nfft < 8 || (nfft & (nfft - 1)) != 0 || na + nb == 0){
+        usage();
+        return 1;
+    }
+    FILE* file = fopen(path, "r");
+    if(file == NULL){
+        perror(path);
+        return 1;
+    }
+
+    Spectra spectra(nfft);
+    ArxFit fit(na, nb);
+    char line[256];
+    double t_first = -1;
+    double t_last = 0;
+    size_t count = 0;
+    while(fgets(line, sizeof(line), file) != NULL){
+        double t, d, u, y;
+        if(sscanf(line, "%lf,%lf,%lf,%lf", &t, &d, &u, &y) != 4){
+            // Header or a broken line
+            continue;
+        }
+        if(t_first < 0){
+            t_first = t;
+        }
+        t_last = t;
+        spectra.add(d, u, y);
+        fit.add(u, y);
+        count++;
+    }
+    fclose(file);
+
+    if(spectra.segments == 0){
+        fprintf(stderr, "Need at least %zu samples, only got %zu\n", nfft, count);
+        return 1;
+    }
+    double period = (t_last - t_first) / 1e6 / (count - 1);
+    double rate = 1 / period;
+    bool fitted = fit.solve();
+    fprintf(stderr, "%zu samples at %.1f Hz, %zu windows of %zu\n", count, rate, spectra.segments, nfft);
+
+    printf("freq_hz,plant_mag_db,plant_phase_deg,loop_mag_db,loop_phase_deg,coherence_u,coherence_y,model_mag_db,model_phase_deg\n");
+    double prev_mag = 0, prev_phase = 0, prev_freq = 0;
+    // A loop lags, so the first phase is put between -360 and 0 deg
+    double last_phase = -180;
+    double crossover = -1, phase_margin = 0;
+    double phase_cross = -1, gain_margin = 0;
+    for(size_t k = 1; k <= nfft / 2; k++){
+        double freq = k * rate / nfft;
+        if(spectra.s_dd[k] <= 0 || std::abs(spectra.s_ud[k]) <= 0){
+            continue;
+        }
+        cplx plant = spectra.s_yd[k] / spectra.s_ud[k];
+        cplx sens = spectra.s_ud[k] / spectra.s_dd[k];
+        cplx loop = 1.0 / sens - 1.0;
+        double coh_u = std::norm(spectra.s_ud[k]) / (spectra.s_uu[k] * spectra.s_dd[k]);
+        double coh_y = std::norm(spectra.s_yd[k]) / (spectra.s_yy[k] * spectra.s_dd[k]);
+        cplx model = fitted ? fit.response(2 * M_PI * k / nfft) : cplx(0, 0);
+        double l_mag = mag_db(loop);
+        double l_phase = unwrap_deg(phase_deg(loop), last_phase);
+        printf("%.4f,%.3f,%.2f,%.3f,%.2f,%.4f,%.4f,%.3f,%.2f\n", freq,
+               mag_db(plant), phase_deg(plant), l_mag, l_phase, coh_u, coh_y,
+               mag_db(model), phase_deg(model));
+        // Bins the test signal did not reach are just noise
+        if(coh_u < MIN_COHERENCE){
+            prev_freq = 0;
+            continue;
+        }
+        // Only coherent bins move the unwrap, so noise can not add a turn
+        last_phase = l_phase;
+        // First crossings only, interpolated between bins
+        if(prev_freq > 0 && crossover < 0 && prev_mag > 0 && l_mag <= 0){
+            double f = prev_mag / (prev_mag - l_mag);
+            crossover = prev_freq + f * (freq - prev_freq);
+            phase_margin = 180 + prev_phase + f * (l_phase - prev_phase);
+            phase_margin = unwrap_deg(phase_margin, 0);
+        }
+        // Falling through an odd multiple of 180 deg below 0 dB. Near 0 Hz
+        // the loop of an unstable plant sits at -180 deg with gain above
+        // 0 dB, and noise moving it back and forth there is not a margin.
+        double prev_turn = floor((prev_phase + 180) / 360);
+        double turn = floor((l_phase + 180) / 360);
+        if(prev_freq > 0 && phase_cross < 0 && turn < prev_turn && l_mag < 0){
+            double cross = 360 * prev_turn - 180;
+            double f = (prev_phase - cross) / (prev_phase - l_phase);
+            phase_cross = prev_freq + f * (freq - prev_freq);
+            gain_margin = -(prev_mag + f * (l_mag - prev_mag));
+        }
+        prev_mag = l_mag;
+        prev_phase = l_phase;
+        prev_freq = freq;
+    }
+
+    if(crossover > 0){
+        fprintf(stderr, "Loop crossover %.2f Hz, phase margin %.1f deg\n", crossover, phase_margin);
+    }else{
+        fprintf(stderr, "Loop gain does not cross 0 dB in the measured range\n");
+    }
+    if(phase_cross > 0){
+        fprintf(stderr, "Phase crosses -180 deg at %.2f Hz, gain margin %.1f dB\n", phase_cross, gain_margin);
+    }
+    if(fitted){
+        fprintf(stderr, "ARX plant model, T = %.6f s:\n  A(z) = 1", period);
+        for(size_t i = 0; i < na; i++){
+            fprintf(stderr, " %+.6g z^-%zu", fit.a[i], i + 1);
+        }
+        fprintf(stderr, "\n  B(z) =");
+        for(size_t i = 0; i < nb; i++){
+            fprintf(stderr, " %+.6g z^-%zu", fit.b[i], i + 1);
+        }
+        fprintf(stderr, "\n");
+        if(na > 0){
+            std::vector<cplx> poles = roots(fit.a);
+            for(size_t i = 0; i < poles.size(); i++){
+                cplx s = std::log(poles[i]) / period;
+                fprintf(stderr, "  pole z = %.5f%+.5fj  s = %.3f%+.3fj rad/s\n",
+                        poles[i].real(), poles[i].imag(), s.real(), s.imag());
+            }
+        }
+    }else{
+        fprintf(stderr, "Could not fit the ARX model\n");
+    }
+    return 0;
+}